@@ -20,8 +20,6 @@ class Allocator {
 
   size_t peak;  // 保存最近一次 alloc 后所使用内存的最大值
 
-  size_t alignment;  // 执行内存对齐时的参考大小
-
   // pointer to the memory actually allocated
   void *ptr;
 
@@ -74,13 +72,27 @@ class Allocator {
    */
   void *getPtr();
 
+  /**
+   * @brief 返回是否已经通过 getPtr 执行了实际的内存分配
+   */
+  bool isAllocated() const { return ptr != nullptr; }
+
+  /**
+   * @brief 返回模拟分配得到的内存峰值，即 getPtr 实际分配的大小
+   */
+  size_t getPeak() const { return peak; }
+
+  /**
+   * @brief 返回模拟过程中当前仍在使用的内存大小
+   */
+  size_t getUsed() const { return used; }
+
   void info();
 
- private:
   // function: memory alignment, rouned up
   // return: size of the aligned memory block
   /**
-   * @brief 小于等于 size 且是 alignment 整数倍的内存大小
+   * @brief 大于等于 size 且是运行时对齐字节数（RuntimeObj::getAlignment）整数倍的内存大小
    * @param size 需要对齐的内存大小
    * @return size_t 返回对齐后的内存大小
    */
@@ -0,0 +1,86 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "core/runtime.h"
+
+namespace infini {
+
+/**
+ * @brief 异步执行的配置
+ */
+struct AsyncConfig {
+  int maxInFlight = 2;        // 同时执行的请求数，即执行请求的线程数
+  size_t queueCapacity = 16;  // 等待执行的请求队列的容量，队列满时提交会阻塞，直到有请求开始执行
+};
+
+/**
+ * @brief 异步执行计划：提交的请求放入有界队列，由 maxInFlight 个线程取出后调用 runtime->run(plan)
+ * 或 runtime->run(context) 执行，完成后通过 future 或回调通知调用者。执行线程在第一次提交时才创建。
+ * kernel 内部的并行计算仍然使用运行时的线程池；同一个计划（或同一个上下文）的多个请求依次执行，
+ * 同一个计划的不同上下文可以同时执行
+ */
+class AsyncRunner {
+ public:
+  // 请求完成时调用，执行成功时参数为空，否则为执行中抛出的异常。回调抛出的异常会被捕获并打印，不会传播
+  using Callback = std::function<void(std::exception_ptr)>;
+
+ private:
+  struct Request {
+    Plan plan;                 // 与 context 只有一个非空
+    ExecutionContext context;
+    Callback done;
+  };
+
+  const RuntimeObj *runtime;
+  AsyncConfig config;
+  mutable std::mutex mutex;
+  std::condition_variable notEmpty, notFull;
+  std::deque<Request> requests;
+  vector<std::thread> workers;
+  bool stopping = false;
+
+ public:
+  explicit AsyncRunner(const RuntimeObj *runtime, const AsyncConfig &config = {})
+      : runtime(runtime), config(config) {}
+  ~AsyncRunner();
+
+  /**
+   * @brief 修改配置，会先等待已经提交的请求全部完成。不能在执行线程中（例如完成回调里）调用
+   */
+  void configure(const AsyncConfig &config);
+  const AsyncConfig &getConfig() const { return config; }
+
+  /**
+   * @brief 提交一次执行，返回的 future 在执行完成后就绪，执行中的异常由 future.get() 重新抛出
+   */
+  std::future<void> submit(const Plan &plan);
+
+  /**
+   * @brief 提交一次执行，完成后在执行线程中调用 done
+   */
+  void submit(const Plan &plan, Callback done);
+
+  /**
+   * @brief 提交一次在执行上下文中的执行，返回的 future 在执行完成后就绪
+   */
+  std::future<void> submit(const ExecutionContext &context);
+
+  /**
+   * @brief 提交一次在执行上下文中的执行，完成后在执行线程中调用 done
+   */
+  void submit(const ExecutionContext &context, Callback done);
+
+ private:
+  void enqueue(Request request);
+  std::future<void> enqueueWithFuture(Request request);
+  bool isWorkerThread() const;
+  void workerLoop();
+  void stop();
+};
+
+}  // namespace infini
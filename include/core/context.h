@@ -0,0 +1,67 @@
+#pragma once
+#include <mutex>
+#include <unordered_map>
+
+#include "core/plan.h"
+
+namespace infini {
+
+/**
+ * @brief 执行计划的执行上下文。计划及其计算图（算子、kernel、权重、内存规划）不可变，可以被多个上下文共享；
+ * 每个上下文按计划的内存规划申请一块自己的内存，存放图的输入、中间结果和图的输出，
+ * 权重（TensorObj::isWeight）直接使用计算图常驻的权重内存，不会复制。
+ * 因此多个线程各自使用一个上下文就可以同时执行同一个计划
+ */
+class ExecutionContextObj : public Object {
+ private:
+  Plan plan;
+  Runtime runtime;
+  void *arena = nullptr;  // 上下文自己的内存，大小与计算图的内存相同
+  std::unordered_map<TensorObj *, void *> data;  // 每个张量在当前上下文中的数据指针
+  vector<vector<void *>> inputs, outputs;        // 计划中每一项的输入、输出数据指针
+  mutable std::mutex runMutex;  // 同一个上下文的多次执行依次进行
+
+ public:
+  /**
+   * @brief 根据执行计划创建执行上下文
+   * @param plan 由 compile 得到的执行计划
+   */
+  explicit ExecutionContextObj(Plan plan);
+  ~ExecutionContextObj();
+
+  ExecutionContextObj(const ExecutionContextObj &) = delete;
+  ExecutionContextObj &operator=(const ExecutionContextObj &) = delete;
+
+  const Plan &getPlan() const { return plan; }
+  std::mutex &getRunMutex() const { return runMutex; }
+
+  /**
+   * @brief 执行计划中的第 i 项，使用当前上下文的数据指针
+   */
+  void launch(size_t i) const {
+    plan->getEntries()[i].launch(inputs[i].data(), outputs[i].data());
+  }
+
+  /**
+   * @brief 返回张量在当前上下文中的数据指针，用于写入请求输入、读取输出
+   * @tparam T 需要转换到的指针类型
+   */
+  template <typename T>
+  T getRawDataPtr(const Tensor &tensor) const {
+    static_assert(std::is_pointer_v<T>, "Raw data pointer has a type of pointer");
+    auto it = data.find(tensor.get());
+    IT_ASSERT(it != data.end(), "Tensor does not belong to the planned graph");
+    return static_cast<T>(it->second);
+  }
+
+  /**
+   * @brief 用 generator 写入张量在当前上下文中的数据，参数与 TensorObj::setData 相同
+   */
+  void setData(const Tensor &tensor, const std::function<void(void *, size_t, DataType)> &generator) const {
+    generator(getRawDataPtr<void *>(tensor), tensor->size(), tensor->getDType());
+  }
+
+  string toString() const override;
+};
+
+}  // namespace infini
@@ -1,8 +1,10 @@
 #pragma once
 #include <algorithm>
 #include <cstdint>
+#include <unordered_set>
 
 #include "core/allocator.h"
+#include "core/memory_planner.h"
 #include "core/operator.h"
 #include "core/tensor.h"
 
@@ -14,9 +16,12 @@ class GraphObj : public Object {
   TensorVec tensors;    // 保存计算图运行中的所有输入和输出张量
   OpVec ops;            // 依次保存图中的所有算子
   Allocator allocator;  // 用于执行给计算图分配所需要的内存
+  Allocator weightAllocator;   // 为常量权重分配常驻内存，不会与激活值复用
+  Allocator prepackAllocator;  // 为预打包的常量输入分配常驻内存，不会与激活值复用
 
  public:
-  explicit GraphObj(Runtime runtime) : runtime(runtime), allocator(runtime), sorted(false) {};
+  explicit GraphObj(Runtime runtime)
+      : runtime(runtime), allocator(runtime), weightAllocator(runtime), prepackAllocator(runtime), sorted(false) {};
   /**
    * @brief 将所有张量、算子的信息以字符串形式返回
    * @return string 张量、算子构成的信息字符串
@@ -32,6 +37,11 @@ class GraphObj : public Object {
    */
   Tensor addTensor(Shape dim, DataType dtype = DataType::Float32);
 
+  /**
+   * @brief 添加常量权重：与 addTensor 相同，并把张量标记为权重（TensorObj::setWeight）
+   */
+  Tensor addWeight(Shape dim, DataType dtype = DataType::Float32);
+
   /**
    * @brief 将相同运行时中的张量添加到计算图中
    * @param tensor 要加入的张量
@@ -106,12 +116,64 @@ class GraphObj : public Object {
 
   /**
    * @brief 为计算图中的每个张量指定数据应该保存的位置（在张量的 data.ptr
-   * 中保存）
-   * @param useNaiveAllocator 如果此参数为 true，则使用朴素的内存分配器；
-   * 否则先使用 Allocator 模拟分配内存，根据模拟的结果执行实际的内存分配
-   * @param memPoolSize 可以指定是否在 Allocator 中使用内存缓冲池
+   * 中保存）。常量权重依次放在常驻的权重内存中，只设置一次数据，多次推理之间保持不变；
+   * 图的输入和中间结果放在可复用的内存中：依次执行时先按拓扑序计算每个张量的生命周期，
+   * 再由 MemoryPlanner 离线地为这些张量选择偏移量，规划结果可以通过 getMemoryPlan 查看
+   * @param concurrent 为 true 时按算子可能并行执行来规划内存：只有当一个张量的所有使用者
+   * 都是另一个张量生成算子的祖先时，两者才能共用内存（用于 Parallel 调度）
+   * 依次执行时还会消除沿最外层非 1 维度拼接的 Concat：它的输入直接放在输出中对应的位置，
+   * 由生成输入的算子直接写入，Concat 算子不再执行（见 isElided）
+   */
+  void dataMalloc(bool concurrent = false);
+
+  /**
+   * @brief 设置 dataMalloc 是否消除可以只靠内存布局完成的 Concat，默认打开
+   */
+  void setConcatElimination(bool enable) { concatElimination = enable; }
+
+  /**
+   * @brief 返回算子是否被最近一次 dataMalloc 消除。被消除的算子的输出已经由其他算子写好，执行时跳过
+   */
+  bool isElided(const Operator &op) const { return elidedOps.count(op.get()) > 0; }
+
+  /**
+   * @brief 返回最近一次 dataMalloc 的内存规划：总大小、下界（同时存活的张量大小之和的最大值）和使用的策略，
+   * 可以用 MemoryPlan::toString 打印
+   */
+  const MemoryPlan &getMemoryPlan() const { return memoryPlan; }
+
+  /**
+   * @brief 设置内存规划时做精确搜索的张量个数上限，0 表示只使用贪心策略
+   */
+  void setExactPlanLimit(size_t limit) { exactPlanLimit = limit; }
+
+  /**
+   * @brief 返回内存是否按算子并行执行规划（即 dataMalloc(true)）
+   */
+  bool isConcurrentMalloc() const { return concurrentMalloc; }
+
+  /**
+   * @brief 返回 dataMalloc 为输入和中间结果分配的可复用内存的起始地址和大小。
+   * 执行上下文按相同的偏移量在自己的内存中放置这些张量
+   */
+  pair<uint8_t *, size_t> getDataArena();
+
+  /**
+   * @brief 返回 dataMalloc 为常量权重分配的常驻内存的起始地址和大小，执行上下文共享这块内存
+   */
+  pair<uint8_t *, size_t> getWeightArena();
+
+  /**
+   * @brief 返回内存规划中执行到每个算子（按拓扑序）时仍在使用的内存大小，由 dataMalloc 记录
+   */
+  const vector<size_t> &getLiveBytes() const { return liveBytes; }
+
+  /**
+   * @brief 让 kernel 把算子中标记为常量权重（TensorObj::isWeight）的输入一次性重排为其内部格式（例如 GEMM 的面板格式），
+   * 重排结果保存在常驻的 prepackAllocator 中，之后每次推理时 kernel 直接使用，不再重复打包。
+   * 需要在 dataMalloc 并且设置好权重数据之后调用；权重数据改变后需要再次调用以重新打包
    */
-  void dataMalloc();
+  void prepackWeights();
 
   /**
    * @brief 向计算图中添加算子（适用于需要与当前图关联起来的算子）
@@ -139,13 +201,23 @@ class GraphObj : public Object {
   }
 
   /**
-   * @brief 获取当前计算图所有输入张量构成的 vector。Gets input tensors of this
+   * @brief 获取当前计算图所有输入张量（没有源算子且不是权重）构成的 vector。Gets input tensors of this
    * graph.
    */
   inline TensorVec getInputs() const {
     TensorVec ret;
     for (const auto &t : tensors)
-      if (!t->getSource()) ret.emplace_back(t);
+      if (!t->getSource() && !t->isWeight()) ret.emplace_back(t);
+    return ret;
+  }
+
+  /**
+   * @brief 获取当前计算图所有常量权重构成的 vector
+   */
+  inline TensorVec getWeights() const {
+    TensorVec ret;
+    for (const auto &t : tensors)
+      if (t->isWeight()) ret.emplace_back(t);
     return ret;
   }
 
@@ -176,10 +248,45 @@ class GraphObj : public Object {
    */
   void addOperatorAndConnect(const Operator &op);
 
+  /**
+   * @brief 并行调度下的内存规划，返回每个张量相对于内存起始地址的偏移量
+   */
+  std::unordered_map<TensorObj *, size_t> planConcurrentOffsets();
+
+  /**
+   * @brief 找出可以消除的 Concat（沿最外层非 1 维度拼接，每个输入都是只属于它的中间结果），记录到 elidedOps 中。
+   * 返回每个被放进其他张量中的输入张量对应的最外层张量和字节偏移量（嵌套的 Concat 已经展开）
+   */
+  std::unordered_map<TensorObj *, pair<TensorObj *, size_t>> planConcatViews();
+
+  /**
+   * @brief 把所有常量权重依次放在常驻的权重内存中
+   */
+  void weightMalloc();
+
   /**
    * @brief 记录图中的算子是否已经按照拓扑排序排好
    */
   bool sorted;
+
+  /**
+   * @brief 记录内存是否按算子并行执行规划
+   */
+  bool concurrentMalloc = false;
+
+  /**
+   * @brief 执行到每个算子时仍在使用的内存大小
+   */
+  vector<size_t> liveBytes;
+
+  /**
+   * @brief 被 dataMalloc 消除、执行时跳过的算子
+   */
+  std::unordered_set<OperatorObj *> elidedOps;
+  bool concatElimination = true;
+
+  MemoryPlan memoryPlan;
+  size_t exactPlanLimit = MemoryPlanner::DefaultExactLimit;
 };
 
 }  // namespace infini
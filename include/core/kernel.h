@@ -10,6 +10,11 @@ namespace infini {
 
 class RuntimeObj;
 
+/**
+ * @brief 预先解析好的 kernel 调用，参数依次为算子输入、输出张量的数据指针（与算子中的顺序相同）
+ */
+using PreparedKernel = std::function<void(void *const *inputs, void *const *outputs)>;
+
 class Kernel {
  public:
   Kernel() {}
@@ -19,42 +24,134 @@ class Kernel {
    * @brief Executes an op with a default parameter.
    */
   virtual void compute(const Operator &op, const RuntimeObj *context) const = 0;
+
+  /**
+   * @brief 返回将算子的常量输入（权重）预先重排为 kernel 内部格式所需的字节数，
+   * 返回 0 表示该 kernel 不需要预打包
+   */
+  virtual size_t getPrepackSize(const Operator &op, const RuntimeObj *context) const { return 0; }
+
+  /**
+   * @brief 将算子的常量输入一次性重排到 buffer 中，之后每次执行时 kernel 直接使用重排后的数据
+   * @param buffer 大小为 getPrepackSize 字节的缓冲
+   */
+  virtual void prepack(const Operator &op, const RuntimeObj *context, void *buffer) const {}
+
+  /**
+   * @brief 编译执行计划时对每个算子调用一次，预先完成算子类型转换、形状解码、数据类型分派等工作，
+   * 返回的函数每次执行时只需要数据指针。默认实现在执行时直接调用 compute（使用张量中的数据指针）
+   */
+  virtual PreparedKernel prepare(const Operator &op, const RuntimeObj *context) const {
+    return [this, op, context](void *const *, void *const *) { compute(op, context); };
+  }
+
+ protected:
+  /**
+   * @brief 以张量当前的数据指针执行 prepare 返回的函数，实现了 prepare 的 kernel 可以用它实现 compute
+   */
+  void computePrepared(const Operator &op, const RuntimeObj *context) const {
+    vector<void *> inputs, outputs;
+    for (const auto &input : op->getInputs()) inputs.push_back(input->getRawDataPtr<void *>());
+    for (const auto &output : op->getOutputs()) outputs.push_back(output->getRawDataPtr<void *>());
+    prepare(op, context)(inputs.data(), outputs.data());
+  }
 };
 
+/**
+ * @brief 保存每种 kernel 属性对应的所有候选实现。同一属性可以注册多个名称不同的实现（例如不同的分块方式），
+ * 第一个注册的是默认实现；自动调优为算子选定其他实现时把名称记录在算子中。
+ * 属性中包含算子第一个输入的数据类型，查找时先匹配该数据类型，再匹配以 AnyDType 注册的、不区分数据类型的实现，
+ * 都没有时在编译执行计划（查找 kernel）时报错
+ */
 class KernelRegistry {
  public:
   using KernelRecord = tuple<Kernel *const, const string, const int>;  // Kernel, name, ID
+  static constexpr int AnyDType = -1;
 
  private:
-  std::map<KernelAttrs, KernelRecord> kernels;
+  std::map<KernelAttrs, vector<KernelRecord>> kernels;
   int nKernels = 0;
 
  public:
   ~KernelRegistry() {
-    for (auto &[k, v] : kernels) delete std::get<0>(v);
+    for (auto &[k, records] : kernels)
+      for (auto &record : records) delete std::get<0>(record);
   }
   static KernelRegistry &getInstance() {
     static KernelRegistry instance;
     return instance;
   }
   bool registerKernel(const KernelAttrs &key, Kernel *kernel, string name) {
-    IT_ASSERT(kernels.find(key) == kernels.end(), "Kernel already registered");
-    kernels.emplace(key, KernelRecord{kernel, name, ++nKernels});
+    auto &records = kernels[key];
+    for (auto &record : records) IT_ASSERT(std::get<1>(record) != name, "Kernel already registered: " + name);
+    records.emplace_back(kernel, name, ++nKernels);
     return true;
   }
   /**
-   * @brief 根据传入的 kernelAttrs 属性返回对应类型的的 kernel
+   * @brief 根据传入的 kernelAttrs 属性返回对应类型的默认 kernel
    * @param kernelAttrs 所需 kernel 的属性
    * @return Kernel* 所需的 kernel
    */
-  Kernel *getKernel(const KernelAttrs &kernelAttrs) const {
+  Kernel *getKernel(const KernelAttrs &kernelAttrs) const { return std::get<0>(getKernelItem(kernelAttrs)); }
+  const KernelRecord &getKernelItem(const KernelAttrs &kernelAttrs) const {
+    return getKernelCandidates(kernelAttrs).front();
+  }
+
+  /**
+   * @brief 按名称返回候选实现，name 为空时返回默认实现
+   */
+  const KernelRecord &getKernelItem(const KernelAttrs &kernelAttrs, const string &name) const {
+    const auto &records = getKernelCandidates(kernelAttrs);
+    if (name.empty()) return records.front();
+    for (auto &record : records)
+      if (std::get<1>(record) == name) return record;
+    IT_ASSERT(false, "Kernel " + name + " not found for key {" + get_kernel_attrs_str(kernelAttrs) + "}");
+    return records.front();
+  }
+
+  /**
+   * @brief 返回算子在 device 上查找 kernel 使用的属性
+   */
+  static KernelAttrs getKernelAttrs(Device device, const Operator &op) {
+    return KernelAttrs{device, op->getOpType().underlying(), op->getDType().getIndex()};
+  }
+
+  /**
+   * @brief 返回算子在 device 上使用的 kernel：自动调优选定的实现，没有选定时为默认实现
+   */
+  const KernelRecord &getKernelItem(Device device, const Operator &op) const {
+    return getKernelItem(getKernelAttrs(device, op), op->getKernelName());
+  }
+
+  /**
+   * @brief 返回 kernelAttrs 对应的所有候选实现，第一个为默认实现
+   */
+  const vector<KernelRecord> &getKernelCandidates(const KernelAttrs &kernelAttrs) const {
     auto it = kernels.find(kernelAttrs);
+    if (it == kernels.end())
+      it = kernels.find(KernelAttrs{std::get<0>(kernelAttrs), std::get<1>(kernelAttrs), AnyDType});
     IT_ASSERT(it != kernels.end(), "Kernel not found for key {" + get_kernel_attrs_str(kernelAttrs) + "}");
-    return std::get<0>(it->second);
+    return it->second;
   }
-  const KernelRecord &getKernelItem(const KernelAttrs &kernelAttrs) const { return kernels.at(kernelAttrs); }
 };
 
+/**
+ * @brief 为 DTypes 中的每个数据类型注册一个 kernel。K 是以数据类型索引为参数的类模板时，
+ * 每个数据类型注册各自在编译期实例化的 K<dtype>，执行时不再按数据类型分派；
+ * 否则为每个数据类型注册一个 K 对象
+ */
+template <template <int> class K, int... DTypes>
+bool registerKernels(Device device, OpType::underlying_t opType, const string &name) {
+  (KernelRegistry::getInstance().registerKernel(KernelAttrs{device, opType, DTypes}, new K<DTypes>(), name), ...);
+  return true;
+}
+
+template <typename K, int... DTypes>
+bool registerKernels(Device device, OpType::underlying_t opType, const string &name) {
+  (KernelRegistry::getInstance().registerKernel(KernelAttrs{device, opType, DTypes}, new K(), name), ...);
+  return true;
+}
+
 class CpuKernelWithoutConfig : public Kernel {
  public:
   virtual void compute(const Operator &op, const RuntimeObj *context) const = 0;
@@ -62,11 +159,22 @@ class CpuKernelWithoutConfig : public Kernel {
 
 }  // namespace infini
 
-#define _REGISTER_KERNEL_1(device, opType, kernel, name, cnt)                                             \
-  namespace infini {                                                                                      \
-  static const bool _CAT(_register_kernel_,                                                               \
-                         cnt) = KernelRegistry::getInstance().registerKernel(KernelAttrs{device, opType}, \
-                                                                             new kernel(), name);         \
+// 注册不区分数据类型的 kernel（按元素大小或由算子属性决定数据类型的实现）
+#define _REGISTER_KERNEL_1(device, opType, kernel, name, cnt)                                       \
+  namespace infini {                                                                                \
+  static const bool _CAT(_register_kernel_, cnt) = KernelRegistry::getInstance().registerKernel(    \
+      KernelAttrs{device, opType, KernelRegistry::AnyDType}, new kernel(), name);                   \
   }
 
 #define REGISTER_KERNEL(device, opType, kernel, name) _REGISTER_KERNEL_1(device, opType, kernel, name, __COUNTER__)
+
+// 只为给出的数据类型索引注册 kernel，其他数据类型的算子在编译执行计划时报错，例如
+//   REGISTER_KERNEL_TYPES(Device::CPU, OpType::Add, NativeElementWise, "addNaive_CPU", 1, 6)
+#define _REGISTER_KERNEL_TYPES_1(device, opType, kernel, name, cnt, ...) \
+  namespace infini {                                                     \
+  static const bool _CAT(_register_kernel_, cnt) =                       \
+      registerKernels<kernel, __VA_ARGS__>(device, opType, name);        \
+  }
+
+#define REGISTER_KERNEL_TYPES(device, opType, kernel, name, ...) \
+  _REGISTER_KERNEL_TYPES_1(device, opType, kernel, name, __COUNTER__, __VA_ARGS__)
@@ -0,0 +1,79 @@
+#pragma once
+#include "core/common.h"
+
+namespace infini {
+
+/**
+ * @brief 一块内存的大小和生命周期：从第 begin 个算子写入到第 end 个算子最后一次读取（按拓扑序，闭区间）。
+ * 生命周期有交集的内存块不能重叠，偏移量是 alignment 的整数倍
+ */
+struct LiveInterval {
+  size_t bytes;
+  size_t begin, end;
+  size_t alignment = 1;
+};
+
+/**
+ * @brief 内存规划的结果
+ */
+struct MemoryPlan {
+  vector<size_t> offsets;  // 每个内存块相对于起始地址的偏移量
+  size_t size = 0;         // 需要的内存总大小
+  size_t lowerBound = 0;   // 同时存活的内存块大小之和的最大值，任何规划都不会小于它
+  string strategy;         // 得到该结果的策略
+
+  /**
+   * @brief 规划结果比下界多出的比例
+   */
+  double getGap() const { return lowerBound ? double(size - lowerBound) / double(lowerBound) : 0.0; }
+  string toString() const;
+};
+
+/**
+ * @brief 离线的内存规划：已知所有内存块的生命周期，为每块选择偏移量，使总内存尽量小。
+ * 依次尝试按大小贪心、按宽度贪心，内存块较少时再做精确搜索，返回总内存最小的结果
+ */
+class MemoryPlanner {
+ public:
+  // 对齐要求不同的内存块可选的位置更多，9 块以内的精确搜索可以在 exactBudget 内完成
+  static constexpr size_t DefaultExactLimit = 9;
+
+ private:
+  size_t exactLimit;   // 内存块个数不超过它时做精确搜索，0 表示不搜索
+  size_t exactBudget;  // 精确搜索最多展开的节点数，超过时返回已经找到的最好结果
+
+ public:
+  explicit MemoryPlanner(size_t exactLimit = DefaultExactLimit, size_t exactBudget = 1 << 20)
+      : exactLimit(exactLimit), exactBudget(exactBudget) {}
+
+  /**
+   * @brief 用所有策略规划并返回总内存最小的结果
+   * @param intervals 内存块，大小需要已经对齐
+   * @param numSteps 算子个数，所有生命周期都位于 [0, numSteps) 中
+   */
+  MemoryPlan plan(const vector<LiveInterval> &intervals, size_t numSteps) const;
+
+  /**
+   * @brief 按大小从大到小依次放置，每块放在与它生命周期重叠的已放置内存块之间最小的合适空隙中
+   */
+  static MemoryPlan greedyBySize(const vector<LiveInterval> &intervals, size_t numSteps);
+
+  /**
+   * @brief 按宽度（该步存活的内存块大小之和）从大到小处理每一步，
+   * 把该步存活但还未放置的内存块按大小从大到小放入最小的合适空隙中
+   */
+  static MemoryPlan greedyByBreadth(const vector<LiveInterval> &intervals, size_t numSteps);
+
+  /**
+   * @brief 分支限界搜索：任何规划都可以把每个内存块向下移动到 0 或某个重叠内存块的末尾（向上对齐后），
+   * 因此按偏移量从小到大枚举每一块放在哪个候选位置即可找到最优解。以 initial 为初始上界
+   */
+  MemoryPlan exact(const vector<LiveInterval> &intervals, size_t numSteps, const MemoryPlan &initial) const;
+
+  /**
+   * @brief 返回每一步存活的内存块大小之和
+   */
+  static vector<size_t> getLiveBytes(const vector<LiveInterval> &intervals, size_t numSteps);
+};
+
+}  // namespace infini
@@ -18,6 +18,7 @@ struct OpType {
     Div,
     Mul,
     MatMul,
+    QuantizedMatMul,
     Relu,
     Sub,
     Transpose,
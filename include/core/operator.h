@@ -4,7 +4,8 @@
 #include "core/tensor.h"
 
 namespace infini {
-using KernelAttrs = std::tuple<Device, OpType::underlying_t>;
+// kernel 的分派键：设备、算子类型和第一个输入的数据类型索引（KernelRegistry::AnyDType 表示不区分数据类型）
+using KernelAttrs = std::tuple<Device, OpType::underlying_t, int>;
 
 class GraphObj;
 class OperatorObj : public Object {
@@ -16,6 +17,8 @@ class OperatorObj : public Object {
   TensorVec outputs;                       // 算子可能有多个输出，都保存在 outputs 中
   vector<WRef<OperatorObj>> predecessors;  // 以 weak_ptr 的形式保存当前算子的所有前驱算子
   vector<WRef<OperatorObj>> successors;    // 以 weak_ptr 的形式保存当前算子的所有后继算子
+  Blob prepacked;  // kernel 预先重排好的常量输入（例如打包后的矩阵乘权重），为空表示没有预打包
+  string kernelName;  // 自动调优为算子选定的 kernel 名称，为空表示使用默认的 kernel
 
  public:
   OperatorObj(OpType opType, TensorVec inputs, TensorVec outputs);
@@ -94,6 +97,24 @@ class OperatorObj : public Object {
    */
   OpVec getSuccessors() const { return wrefs_to_refs(successors); }
 
+  /**
+   * @brief 返回 kernel 预先重排好的常量输入数据，为空表示没有预打包
+   */
+  const Blob &getPrepackedData() const { return prepacked; }
+  void setPrepackedData(const Blob &blob) { prepacked = blob; }
+
+  /**
+   * @brief 返回为算子选定的 kernel 名称，为空表示使用 KernelRegistry 中的默认 kernel
+   */
+  const string &getKernelName() const { return kernelName; }
+  void setKernelName(const string &name) { kernelName = name; }
+
+  /**
+   * @brief 返回决定 kernel 性能的算子特征（类型、输入输出的形状和数据类型以及影响计算方式的属性），
+   * 用作自动调优缓存的键，不包含 guid，因此在不同的进程之间保持不变
+   */
+  virtual string getTuningKey() const;
+
   OpType getOpType() const { return type; }
   // HACK: set correct data type
   DataType getDType() const { return getInputs(0)->getDType(); }
@@ -101,6 +122,19 @@ class OperatorObj : public Object {
   virtual int numInputs() const = 0;
   virtual int numOutputs() const = 0;
 
+  /**
+   * @brief 返回可以与唯一的输出共用内存的输入下标。kernel 对这些输入逐元素先读后写，
+   * 因此当该输入在当前算子之后不再被使用时，内存规划可以把输出直接放在该输入的内存上原地计算。
+   * 默认不支持原地计算
+   */
+  virtual vector<int> getInplaceInputs() const { return {}; }
+
+  /**
+   * @brief 返回算子一次计算的浮点（或整数）运算次数，用于性能分析。
+   * 默认每个输出元素一次运算；只搬运数据的算子返回 0
+   */
+  virtual double getFlops() const;
+
   /**
    * @brief Clone this operator and replace its inputs and outputs.
    *
@@ -0,0 +1,42 @@
+#pragma once
+#include <mutex>
+
+#include "core/graph.h"
+#include "core/kernel.h"
+
+namespace infini {
+
+/**
+ * @brief 由 RuntimeObj::compile 得到的不可变执行计划。每一项保存算子对应的 kernel、
+ * kernel 预先解析好的调用、输入输出的数据指针以及算子之间的依赖关系，执行时只需要依次（或按依赖并行）调用
+ */
+class PlanObj : public Object {
+ public:
+  struct Entry {
+    Operator op;
+    size_t step = 0;  // 算子在计算图拓扑序中的下标（被消除的算子不在计划中）
+    Kernel *kernel = nullptr;
+    string kernelName;
+    PreparedKernel launch;
+    vector<void *> inputs;   // 输入张量的数据指针，与算子的输入顺序相同
+    vector<void *> outputs;  // 输出张量的数据指针，与算子的输出顺序相同
+    vector<size_t> successors;   // 后继算子在计划中的下标
+    size_t numPredecessors = 0;  // 前驱算子的个数，并行调度时全部完成后才能执行当前项
+  };
+
+ private:
+  Graph graph;  // 持有计算图，保证计划中的数据指针在计划的生命周期内有效
+  vector<Entry> entries;
+  mutable std::mutex runMutex;  // 计划的所有执行共用同一组数据指针，同一时间只能有一个执行
+
+ public:
+  PlanObj(Graph graph, vector<Entry> entries) : graph(std::move(graph)), entries(std::move(entries)) {}
+
+  const Graph &getGraph() const { return graph; }
+  const vector<Entry> &getEntries() const { return entries; }
+  std::mutex &getRunMutex() const { return runMutex; }
+
+  string toString() const override;
+};
+
+}  // namespace infini
@@ -0,0 +1,87 @@
+#pragma once
+#include <mutex>
+#include <unordered_map>
+
+#include "core/operator.h"
+#include "utils/perf_counters.h"
+
+namespace infini {
+
+/**
+ * @brief 一个算子（或一组算子）的性能统计，flops 和字节数为每次计算的值
+ */
+struct ProfileRecord {
+  string name;        // 单个算子时为算子的描述，汇总时为算子类型或 kernel 名称
+  string opType;
+  string kernelName;
+  size_t calls = 0;
+  double seconds = 0;  // 所有调用的总耗时
+  double flops = 0;
+  size_t bytesRead = 0, bytesWritten = 0;
+  bool hasCounters = false;    // 是否记录了硬件计数器
+  PerfCounterValues counters;  // 所有调用的硬件计数器累计值
+};
+
+/**
+ * @brief 逐算子的性能分析：记录每个算子每次执行的耗时、读写的字节数和运算次数，
+ * 并按算子类型、kernel 名称汇总，输出按耗时排序的表格或 JSON。可以在多个线程中同时记录
+ */
+class Profiler {
+ private:
+  mutable std::mutex mutex;
+  std::unordered_map<UidBaseType, size_t> index;  // 算子的 guid 在 records 中的下标
+  vector<ProfileRecord> records;                  // 按第一次记录的顺序保存
+  size_t runs = 0;
+
+ public:
+  /**
+   * @brief 记录算子的一次执行
+   * @param op 执行的算子
+   * @param kernelName 执行算子的 kernel 在 KernelRegistry 中的名称
+   * @param seconds 执行耗时
+   * @param counters 执行期间的硬件计数器增量，为空表示没有统计
+   */
+  void record(const Operator &op, const string &kernelName, double seconds,
+              const PerfCounterValues *counters = nullptr);
+
+  /**
+   * @brief 一次完整的推理结束，返回已经记录的推理次数
+   */
+  size_t endRun();
+  size_t getNumRuns() const;
+
+  void reset();
+
+  /**
+   * @brief 返回每个算子的统计，按总耗时从大到小排序
+   */
+  vector<ProfileRecord> getRecords() const;
+
+  /**
+   * @brief 按算子类型汇总的统计，按总耗时从大到小排序
+   */
+  vector<ProfileRecord> getRecordsByOpType() const;
+
+  /**
+   * @brief 按 kernel 名称汇总的统计，按总耗时从大到小排序
+   */
+  vector<ProfileRecord> getRecordsByKernel() const;
+
+  /**
+   * @brief 返回可读的汇总表格：按算子类型、按 kernel 和逐个算子三张表；
+   * 记录了硬件计数器时再加上每个算子的 IPC、最后一级缓存缺失率和分支预测失败率
+   */
+  string summary() const;
+
+  /**
+   * @brief 返回 JSON 格式的统计，便于脚本处理
+   */
+  string toJson() const;
+
+  /**
+   * @brief 把 toJson 的结果写入文件
+   */
+  void writeJson(const string &path) const;
+};
+
+}  // namespace infini
@@ -1,7 +1,14 @@
 #pragma once
+#include <exception>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+
 #include "core/common.h"
 #include "core/op_type.h"
 #include "core/ref.h"
+#include "utils/mmap_arena.h"
+#include "utils/thread_pool.h"
 
 namespace infini {
 class TensorObj;
@@ -9,12 +16,21 @@ class OperatorObj;
 class GraphObj;
 class RuntimeObj;
 class BlobObj;
+class PlanObj;
+class ExecutionContextObj;
+class AsyncRunner;
+class Profiler;
+class Tracer;
+class KernelTuner;
+struct AsyncConfig;
 
 using Tensor = Ref<TensorObj>;
 using Operator = Ref<OperatorObj>;
 using Graph = Ref<GraphObj>;
 using Runtime = Ref<RuntimeObj>;
 using Blob = Ref<BlobObj>;
+using Plan = Ref<PlanObj>;
+using ExecutionContext = Ref<ExecutionContextObj>;
 
 using TensorVec = vector<Tensor>;
 using OpVec = vector<Operator>;
@@ -27,6 +43,8 @@ enum class Device { CPU = 1 };
 class RuntimeObj : public std::enable_shared_from_this<RuntimeObj> {
  protected:
   Device device;
+  size_t alignment = 64;          // 张量起始地址对齐的字节数
+  size_t pageAlignThreshold = 0;  // 不小于该大小的张量按页对齐，0 表示不按页对齐
 
  public:
   explicit RuntimeObj(Device device) : device(device) {}
@@ -39,10 +57,66 @@ class RuntimeObj : public std::enable_shared_from_this<RuntimeObj> {
    * @param graph 要推理运行的计算图
    */
   virtual void run(const Graph &graph) const = 0;
+
+  /**
+   * @brief 把计算图编译为执行计划：按拓扑顺序为每个算子查找一次 kernel，调用 kernel 的 prepare
+   * 预先解析参数，并记录输入、输出张量的数据指针。需要在 dataMalloc（以及 prepackWeights）之后调用，
+   * 之后重新分配内存或修改计算图都需要重新编译
+   * @param graph 要编译的计算图
+   * @return Plan 不可变的执行计划
+   */
+  Plan compile(const Graph &graph) const;
+
+  /**
+   * @brief compile 开始时调用，为有多个候选 kernel 的算子选择实现。默认不调优，使用默认的 kernel
+   */
+  virtual void tune(const Graph &graph) const {}
+
+  /**
+   * @brief 依次执行计划中的每一项，不再查找 kernel 或解析算子
+   * @param plan 由 compile 得到的执行计划
+   */
+  virtual void run(const Plan &plan) const = 0;
+
+  /**
+   * @brief 在执行上下文中执行计划：权重等共享数据从计划所属的计算图中读取，中间结果写入上下文自己的内存。
+   * 不同的上下文可以在多个线程中同时执行同一个计划
+   * @param context 由计划创建的执行上下文
+   */
+  virtual void run(const ExecutionContext &context) const = 0;
+
   virtual void *alloc(size_t size) = 0;
   virtual void dealloc(void *ptr) = 0;
 
+  /**
+   * @brief 设置张量的对齐方式：每个张量的起始地址和占用的大小都是 alignment（2 的幂）的整数倍，
+   * 默认 64 字节，即一条缓存行，向量化的 kernel 可以使用对齐的加载，不同线程写入的相邻张量也不会共用缓存行；
+   * 不小于 pageAlignThreshold 字节的张量再按页对齐，0 表示不按页对齐。对之后的 dataMalloc 生效
+   */
+  void setAlignment(size_t alignment, size_t pageAlignThreshold = 0);
+  size_t getAlignment() const { return alignment; }
+  size_t getPageAlignThreshold() const { return pageAlignThreshold; }
+
+  /**
+   * @brief 返回 bytes 字节的张量的起始地址需要对齐的字节数
+   */
+  size_t getAlignment(size_t bytes) const;
+
+  /**
+   * @brief 返回 alloc 得到的内存起始地址对齐的字节数，不小于任何张量需要的对齐
+   */
+  size_t getBaseAlignment() const;
+
+  static size_t getPageSize();
+
+  /**
+   * @brief 返回运行时拥有的线程池，kernel 通过 compute/prepare 收到的 context 使用它并行计算；
+   * 为空表示只在当前线程计算
+   */
+  virtual ThreadPool *getThreadPool() const { return nullptr; }
+
   bool isCpu() const { return true; }
+  Device getDevice() const { return device; }
 
   /**
    * @brief 返回当前运行时类的名称（不同的子类可以自定义返回的名称）
@@ -57,7 +131,155 @@ class RuntimeObj : public std::enable_shared_from_this<RuntimeObj> {
  */
 class NativeCpuRuntimeObj : public RuntimeObj {
  public:
-  NativeCpuRuntimeObj() : RuntimeObj(Device::CPU) {}
+  /**
+   * @brief 算子之间的调度方式。Sequential 按拓扑顺序依次执行；Parallel 用依赖计数把所有前驱都已完成的算子
+   * 提交到线程池中同时执行，此时计算图需要以 dataMalloc(true) 分配内存
+   */
+  enum class ScheduleMode { Sequential, Parallel };
+
+ private:
+  ScheduleMode scheduleMode = ScheduleMode::Sequential;
+  // 常驻的线程池，算子之间的并行调度和 kernel 内部的并行计算共用，线程总数不会超过配置
+  std::unique_ptr<ThreadPool> threadPool;
+  std::unique_ptr<AsyncRunner> asyncRunner;  // 执行异步提交的请求，在线程池之前析构
+  std::unique_ptr<Profiler> profiler;
+  bool profiling = false;
+  size_t profileReportRuns = 0;  // 非 0 时在第 N 次推理结束后输出汇总
+  string profileOutput;          // 非空时输出汇总的同时把 JSON 写入该文件
+  bool hardwareCounters = false;  // 性能分析时是否同时统计硬件计数器
+  std::unique_ptr<Tracer> tracer;
+  bool tracing = false;
+  string traceOutput;  // 非空时在运行时析构时把时间线写入该文件
+  std::unique_ptr<KernelTuner> tuner;  // 为空表示不调优
+  MmapArenaConfig mmapConfig;
+  std::mutex mmapMutex;
+  std::unordered_map<void *, MmapRegion> mmapRegions;  // mmap 分配的内存，dealloc 时据此选择 munmap 或 free
+
+  /**
+   * @brief 执行计算图中第 index 个算子并记录耗时（性能分析）和时间线片段
+   */
+  void instrument(const Graph &graph, size_t index, const Operator &op, const string &kernelName,
+                  const std::function<void()> &compute) const;
+
+  /**
+   * @brief 一次推理结束，需要时输出性能分析的汇总
+   */
+  void endProfiledRun() const;
+
+  /**
+   * @brief 按调度方式执行计划中的所有项，run(i) 执行第 i 项；打开性能分析时记录每一项的耗时
+   */
+  void execute(const Plan &plan, const std::function<void(size_t)> &run) const;
+
+  /**
+   * @brief Sequential 模式下依次调用 launch(i)，Parallel 模式下按依赖关系在线程池中并行调用
+   */
+  void schedule(const Plan &plan, const std::function<void(size_t)> &launch) const;
+
+ public:
+  NativeCpuRuntimeObj();
+  ~NativeCpuRuntimeObj() override;
+
+  /**
+   * @brief 设置算子之间的调度方式
+   */
+  void setScheduleMode(ScheduleMode mode) { scheduleMode = mode; }
+  ScheduleMode getScheduleMode() const { return scheduleMode; }
+
+  /**
+   * @brief 按新的配置（线程数、是否绑核、空闲时的自旋时间）重新启动线程池，调用时不能有正在执行的计算
+   */
+  void setThreadPoolConfig(const ThreadPoolConfig &config) { threadPool->configure(config); }
+  const ThreadPoolConfig &getThreadPoolConfig() const { return threadPool->getConfig(); }
+
+  ThreadPool *getThreadPool() const override { return threadPool.get(); }
+
+  /**
+   * @brief 设置大块内存的分配方式：打开后不小于 minSize 的分配使用 mmap，可以使用透明大页或 MAP_HUGETLB 大页、
+   * 绑定到指定的 NUMA 节点，并由线程池并行完成第一次写入。映射失败时退回 aligned_alloc。
+   * 也可以通过环境变量打开：INFINI_HUGE_PAGES=none|transparent|explicit，INFINI_NUMA_NODE=n。对之后的 alloc 生效
+   */
+  void setMmapArenaConfig(const MmapArenaConfig &config) { mmapConfig = config; }
+  const MmapArenaConfig &getMmapArenaConfig() const { return mmapConfig; }
+
+  /**
+   * @brief 返回 alloc 得到的 ptr 对应的 mmap 映射，不是由 mmap 分配时返回空
+   */
+  const MmapRegion *getMmapRegion(void *ptr);
+
+  /**
+   * @brief 设置异步执行同时执行的请求数和提交队列的容量，会先等待已经提交的请求全部完成
+   */
+  void setAsyncConfig(const AsyncConfig &config);
+  const AsyncConfig &getAsyncConfig() const;
+
+  /**
+   * @brief 打开或关闭逐算子的性能分析，记录每个算子的耗时、读写字节数和运算次数。
+   * 也可以通过环境变量打开：INFINI_PROFILE=N 在第 N 次推理结束后把汇总表格打印到标准输出，
+   * 同时设置 INFINI_PROFILE_OUTPUT=path 时把 JSON 格式的统计写入 path
+   */
+  void setProfiling(bool enable) { profiling = enable; }
+  bool isProfiling() const { return profiling; }
+
+  /**
+   * @brief 返回记录统计的 Profiler，可以随时读取汇总或清空
+   */
+  Profiler &getProfiler() const { return *profiler; }
+
+  /**
+   * @brief 性能分析时是否用 perf_event_open 统计每个算子执行期间的硬件计数器（周期、指令、缓存和分支缺失），
+   * 也可以通过环境变量 INFINI_PERF_COUNTERS=1 打开。每个算子的计数为执行 kernel 的线程与线程池中
+   * 为它执行 parallelFor 任务的线程的计数之和；没有权限或 PMU 时打印一次警告并只记录耗时
+   */
+  void setHardwareCounters(bool enable) { hardwareCounters = enable; }
+  bool isHardwareCounters() const { return hardwareCounters; }
+
+  /**
+   * @brief 打开或关闭时间线记录，每个算子的每次执行记录为所在线程上的一个片段，
+   * 通过 getTracer().writeJson(path) 导出后可以在 chrome://tracing 或 Perfetto 中查看。
+   * 也可以通过环境变量 INFINI_TRACE=path 打开，运行时析构时写入 path
+   */
+  void setTracing(bool enable) { tracing = enable; }
+  bool isTracing() const { return tracing; }
+  Tracer &getTracer() const { return *tracer; }
+
+  /**
+   * @brief 打开或关闭 kernel 自动调优：compile 时为有多个候选实现的算子测量每个候选并选择最快的。
+   * cachePath 非空时从该文件读取之前的选择并把新的选择写回。
+   * 也可以通过环境变量打开：INFINI_TUNE=1 只在进程内调优，INFINI_TUNING_CACHE=path 同时使用磁盘缓存
+   */
+  void setTuning(bool enable, const string &cachePath = "");
+  bool isTuning() const { return tuner != nullptr; }
+
+  /**
+   * @brief 打开自动调优时用 KernelTuner 为计算图选择 kernel
+   */
+  void tune(const Graph &graph) const override;
+
+  /**
+   * @brief 异步执行计划，立即返回；提交队列已满时阻塞到有请求开始执行。
+   * 同一个计划的请求依次执行，调用者需要等上一次执行完成后再修改该计划的输入、读取输出。
+   * 需要同一个模型的多个请求同时执行时使用 runAsync(ExecutionContext)
+   * @return std::future<void> 执行完成后就绪，执行中的异常由 get() 重新抛出
+   */
+  std::future<void> runAsync(const Plan &plan) const;
+
+  /**
+   * @brief 异步执行计划，完成后在执行线程中调用 done，执行成功时参数为空，否则为执行中抛出的异常
+   */
+  void runAsync(const Plan &plan, std::function<void(std::exception_ptr)> done) const;
+
+  /**
+   * @brief 在执行上下文中异步执行，立即返回。同一个计划的不同上下文共享计算图和权重，可以同时执行，
+   * 每个上下文同一时间只有一个请求，调用者需要等它完成后再修改该上下文的输入、读取输出
+   * @return std::future<void> 执行完成后就绪，执行中的异常由 get() 重新抛出
+   */
+  std::future<void> runAsync(const ExecutionContext &context) const;
+
+  /**
+   * @brief 在执行上下文中异步执行，完成后在执行线程中调用 done，执行成功时参数为空，否则为执行中抛出的异常
+   */
+  void runAsync(const ExecutionContext &context, std::function<void(std::exception_ptr)> done) const;
 
   /**
    * @brief 定义为单例类型
@@ -75,13 +297,27 @@ class NativeCpuRuntimeObj : public RuntimeObj {
   void dealloc(void *ptr) override;
 
   /**
-   * @brief 遍历所传入 graph 中的所有算子，利用 KernelRegistry 查找对应的 kernel，并执行计算
+   * @brief 遍历所传入 graph 中的所有算子，利用 KernelRegistry 查找对应的 kernel，并执行计算。
+   * Parallel 模式下先编译为执行计划再并行执行
    * @param graph 要推理运行的计算图
    */
   void run(const Graph &graph) const override;
 
   /**
-   * @brief 分配 size 大小的内存空间（会通过运算，保证空间大于等于 size 且是 uint64_t 的整数倍）
+   * @brief 执行计划中的每一项：Sequential 模式下依次执行，Parallel 模式下按依赖关系并行执行
+   * @param plan 由 compile 得到的执行计划
+   */
+  void run(const Plan &plan) const override;
+
+  /**
+   * @brief 在执行上下文中执行计划，调度方式与 run(plan) 相同
+   * @param context 由计划创建的执行上下文
+   */
+  void run(const ExecutionContext &context) const override;
+
+  /**
+   * @brief 分配 size 大小并清零的内存空间，起始地址按 getBaseAlignment() 对齐（空间大于等于 size 且是对齐字节数的整数倍）。
+   * 打开 mmap 分配时较大的内存按 getMmapArenaConfig() 分配
    * @param size 要分配内存的最小值
    * @return void* 返回分配的内存空间的指针
    */
@@ -23,6 +23,7 @@ class TensorObj : public Object {
   WRef<OperatorObj> source;  // 保存生成该 Tensor 的 weak_ptr 类型的 Operator
   Blob data; // 保存 Tensor 中实际的数据（只有一个 runtime 和 ptr 成员，ptr 成员指向保存实际数据的内存）
   Runtime runtime; // 保存 Tensor 的运行时
+  bool weight = false;  // 是否为常量权重
 
  private:
   Shape shape;   // 保存 Tensor 的 shape
@@ -121,6 +122,13 @@ class TensorObj : public Object {
   DataType getDType() const { return dtype; }
   Runtime getRuntime() const { return runtime; }
 
+  /**
+   * @brief 标记张量是否为常量权重：没有源算子、设置一次数据后每次推理都不变。
+   * 权重放在计算图常驻的权重内存中，不会被中间结果覆盖；其他没有源算子的张量是每次推理提供的输入
+   */
+  void setWeight(bool isWeight) { weight = isWeight; }
+  bool isWeight() const { return weight; }
+
   /**
    * @brief 以 weak_ptr 列表的形式返回所有引用该 Tensor 的 Operator
    * @return OpVec 所有引用该 Tensor 的 Operator，以 weak_ptr 的形式返回
@@ -0,0 +1,62 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "core/operator.h"
+
+namespace infini {
+
+/**
+ * @brief 记录计算图执行的时间线，导出为 Chrome trace-event 格式的 JSON（可以在 chrome://tracing 或 Perfetto 中打开）。
+ * 每个算子的每次执行是所在线程上的一个片段，参数中包含算子的 guid、输入输出的形状、数据类型和在内存中的偏移量；
+ * 另有一个计数器轨道显示内存规划中执行到该算子时仍在使用的内存大小。可以在多个线程中同时记录
+ */
+class Tracer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+ private:
+  struct Slice {
+    UidBaseType op;
+    Clock::time_point start, end;
+    int thread;
+    size_t liveBytes;
+  };
+
+  mutable std::mutex mutex;
+  Clock::time_point origin = Clock::now();
+  vector<Slice> slices;
+  std::unordered_map<UidBaseType, pair<string, string>> ops;  // 算子的 guid 到片段的名称和参数
+  std::unordered_map<std::thread::id, int> threads;            // 线程按第一次记录的顺序编号
+
+ public:
+  /**
+   * @brief 记录算子的一次执行
+   * @param op 执行的算子
+   * @param kernelName 执行算子的 kernel 在 KernelRegistry 中的名称
+   * @param arena 算子所属计算图的内存（getDataArena），用于计算张量的偏移量
+   * @param start 开始时间
+   * @param end 结束时间
+   * @param liveBytes 执行该算子时仍在使用的内存大小
+   */
+  void record(const Operator &op, const string &kernelName, pair<uint8_t *, size_t> arena, Clock::time_point start,
+              Clock::time_point end, size_t liveBytes);
+
+  void reset();
+
+  size_t getNumSlices() const;
+
+  /**
+   * @brief 返回 trace-event 格式的 JSON
+   */
+  string toJson() const;
+
+  /**
+   * @brief 把 toJson 的结果写入文件，无法打开或写入失败时抛出异常
+   */
+  void writeJson(const string &path) const;
+};
+
+}  // namespace infini
@@ -0,0 +1,45 @@
+#pragma once
+#include <map>
+#include <mutex>
+
+#include "core/graph.h"
+
+namespace infini {
+
+/**
+ * @brief kernel 自动调优：对计算图中有多个候选实现的算子，用实际的形状和数据分别测量每个候选的耗时，
+ * 选出最快的实现记录在算子中（OperatorObj::setKernelName）。选择结果按 CPU（getCpuSignature）和算子的调优键（getTuningKey）保存，
+ * 指定了缓存文件时从文件中读取已有的选择，新的选择写回文件，之后的进程不需要重新测量
+ */
+class KernelTuner {
+ private:
+  string cachePath;                    // 为空表示不使用磁盘缓存
+  std::map<string, string> choices;    // 当前 CPU 上调优键到 kernel 名称
+  vector<string> otherCpus;            // 缓存文件中其他 CPU 的记录，保存时原样写回
+  bool loaded = false;
+  int repeats;                         // 每个候选测量的次数，取最小值
+  std::mutex mutex;
+
+  void load();
+  void save() const;
+
+ public:
+  explicit KernelTuner(string cachePath = "", int repeats = 5) : cachePath(std::move(cachePath)), repeats(repeats) {}
+
+  const string &getCachePath() const { return cachePath; }
+
+  /**
+   * @brief 为计算图中的算子选择 kernel，需要在 dataMalloc 之后调用。
+   * 测量在调优器自己申请的内存中进行，不会改动计算图中张量的数据；已经预打包的权重会按选中的 kernel 重新打包
+   * @param graph 要调优的计算图
+   * @param runtime 执行 kernel 的运行时
+   */
+  void tune(const Graph &graph, const RuntimeObj *runtime);
+
+  /**
+   * @brief 返回当前 CPU 上的所有选择（调优键到 kernel 名称）
+   */
+  std::map<string, string> getChoices();
+};
+
+}  // namespace infini
@@ -0,0 +1,22 @@
+#pragma once
+#ifndef CONCAT_H
+#define CONCAT_H
+
+#include <cstddef>
+
+namespace infini {
+
+/**
+ * @brief 返回 Concat 内核改用流式写入的输出大小阈值（字节），输出大于该值时绕过缓存写入。
+ * 默认为最后一级缓存的大小（getLastLevelCacheSize）
+ */
+size_t getConcatStreamThreshold();
+
+/**
+ * @brief 设置流式写入的阈值，0 表示恢复默认值。在 prepare（编译计划）时读取，已经编译的计划不受影响
+ */
+void setConcatStreamThreshold(size_t bytes);
+
+}  // namespace infini
+
+#endif
@@ -0,0 +1,180 @@
+#pragma once
+#ifndef KERNELS_CPU_ELEMENT_WISE_H
+#define KERNELS_CPU_ELEMENT_WISE_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "utils/cpu_info.h"
+#include "utils/operator_utils.h"
+#include "utils/thread_pool.h"
+
+namespace infini {
+
+/**
+ * 逐元素算子的内核框架（只有头文件）。
+ *
+ * 一元、二元运算以编译期仿函数的形式给出，仿函数对单个元素求值，例如
+ *   struct AddOp { template <typename T> T operator()(T a, T b) const { return a + b; } };
+ * 框架把仿函数内联到按指令集（标量/SSE4.1/AVX2/AVX-512）分别编译的循环中，由编译器向量化，
+ * 启动时根据 CPUID 为每个 (数据类型, 仿函数) 的组合选出一次最优的版本，对较大的张量再在运行时的线程池上分块并行。
+ */
+
+// 逐元素 kernel 注册的数据类型索引：Float32, UInt8, Int8, UInt16, Int16, Int32, Int64, Double, UInt32, UInt64
+#define ELEMENT_WISE_DTYPES 1, 2, 3, 4, 5, 6, 7, 11, 12, 13
+
+enum class ElementWiseIsa { Scalar, SSE41, AVX2, AVX512 };
+
+/**
+ * @brief 返回逐元素内核使用的指令集，只在第一次调用时根据 CPUID 选择一次
+ */
+inline ElementWiseIsa getElementWiseIsa() {
+  static const ElementWiseIsa isa = [] {
+#if defined(__x86_64__)
+    const auto &features = getCpuFeatures();
+    if (features.avx512f && features.avx512bw && features.avx512vl) return ElementWiseIsa::AVX512;
+    if (features.avx2 && features.fma) return ElementWiseIsa::AVX2;
+    if (features.sse41) return ElementWiseIsa::SSE41;
+#endif
+    return ElementWiseIsa::Scalar;
+  }();
+  return isa;
+}
+
+inline const char *getElementWiseIsaName(ElementWiseIsa isa) {
+  switch (isa) {
+    case ElementWiseIsa::AVX512: return "avx512";
+    case ElementWiseIsa::AVX2: return "avx2";
+    case ElementWiseIsa::SSE41: return "sse4.1";
+    default: return "scalar";
+  }
+}
+
+// 元素总数不低于该值时才启用多线程，每个线程至少处理这么多元素
+constexpr size_t kElementWiseGrain = 1 << 15;
+
+namespace element_wise {
+
+// 连续的一元运算：c[i] = op(a[i])，输入和输出可以是不同的类型
+template <typename TIn, typename TOut, typename Op>
+using UnaryRunFn = void (*)(const Op &op, const TIn *a, TOut *c, size_t len);
+
+// 二元运算的一段最内层运行，输入的跨度只可能是 1（连续）或 0（标量广播）
+template <typename T, typename Op>
+using BinaryRunFn = void (*)(const Op &op, const T *a, size_t strideA, const T *b, size_t strideB, T *c, size_t len);
+
+// 同一个循环体按不同的指令集各编译一份，仿函数被内联后由编译器向量化
+#define INFINI_ELEMENT_WISE_RUNS(SUFFIX, TARGET)                                                              \
+  template <typename TIn, typename TOut, typename Op>                                                         \
+  TARGET void unaryRun##SUFFIX(const Op &op, const TIn *a, TOut *c, size_t len) {                             \
+    _Pragma("omp simd") for (size_t i = 0; i < len; ++i) c[i] = op(a[i]);                                     \
+  }                                                                                                           \
+  template <typename T, typename Op>                                                                          \
+  TARGET void binaryRun##SUFFIX(const Op &op, const T *a, size_t strideA, const T *b, size_t strideB, T *c,   \
+                                size_t len) {                                                                 \
+    if (strideA && strideB) {                                                                                 \
+      _Pragma("omp simd") for (size_t i = 0; i < len; ++i) c[i] = op(a[i], b[i]);                             \
+    } else if (strideA) {                                                                                     \
+      const T vb = b[0];                                                                                      \
+      _Pragma("omp simd") for (size_t i = 0; i < len; ++i) c[i] = op(a[i], vb);                               \
+    } else if (strideB) {                                                                                     \
+      const T va = a[0];                                                                                      \
+      _Pragma("omp simd") for (size_t i = 0; i < len; ++i) c[i] = op(va, b[i]);                               \
+    } else {                                                                                                  \
+      std::fill(c, c + len, op(a[0], b[0]));                                                                  \
+    }                                                                                                         \
+  }
+
+INFINI_ELEMENT_WISE_RUNS(Scalar, )
+#if defined(__x86_64__)
+INFINI_ELEMENT_WISE_RUNS(SSE41, __attribute__((target("sse4.1"))))
+INFINI_ELEMENT_WISE_RUNS(AVX2, __attribute__((target("avx2,fma"))))
+INFINI_ELEMENT_WISE_RUNS(AVX512, __attribute__((target("avx512f,avx512bw,avx512vl"))))
+#endif
+
+#undef INFINI_ELEMENT_WISE_RUNS
+
+template <typename TIn, typename TOut, typename Op>
+UnaryRunFn<TIn, TOut, Op> selectUnaryRun() {
+  switch (getElementWiseIsa()) {
+#if defined(__x86_64__)
+    case ElementWiseIsa::AVX512: return unaryRunAVX512<TIn, TOut, Op>;
+    case ElementWiseIsa::AVX2: return unaryRunAVX2<TIn, TOut, Op>;
+    case ElementWiseIsa::SSE41: return unaryRunSSE41<TIn, TOut, Op>;
+#endif
+    default: return unaryRunScalar<TIn, TOut, Op>;
+  }
+}
+
+template <typename T, typename Op>
+BinaryRunFn<T, Op> selectBinaryRun() {
+  switch (getElementWiseIsa()) {
+#if defined(__x86_64__)
+    case ElementWiseIsa::AVX512: return binaryRunAVX512<T, Op>;
+    case ElementWiseIsa::AVX2: return binaryRunAVX2<T, Op>;
+    case ElementWiseIsa::SSE41: return binaryRunSSE41<T, Op>;
+#endif
+    default: return binaryRunScalar<T, Op>;
+  }
+}
+
+// 把 [0, n) 划分为若干块，返回块数；元素较少或只有一个线程时不划分
+inline size_t getElementWiseChunks(const ThreadPool *pool, size_t n) {
+  return std::max<size_t>(1, std::min<size_t>(getNumThreads(pool), n / kElementWiseGrain));
+}
+
+}  // namespace element_wise
+
+/**
+ * @brief 把 [0, n) 均匀地分成若干块在 pool 上并行计算，每块以 (begin, end) 调用一次 func；pool 为空时在当前线程计算
+ */
+template <typename F>
+void elementWiseParallel(ThreadPool *pool, size_t n, F &&func) {
+  const size_t chunks = element_wise::getElementWiseChunks(pool, n);
+  if (chunks == 1) return func(size_t(0), n);
+  parallelFor(pool, chunks, [&](size_t chunk) { func(n * chunk / chunks, n * (chunk + 1) / chunks); });
+}
+
+/**
+ * @brief 对连续存放的 n 个元素计算 c[i] = op(a[i])。输入和输出类型相同时 a 与 c 可以是同一块内存
+ */
+template <typename TIn, typename TOut, typename Op>
+void elementWiseUnary(ThreadPool *pool, const Op &op, const TIn *a, TOut *c, size_t n) {
+  static const auto run = element_wise::selectUnaryRun<TIn, TOut, Op>();
+  elementWiseParallel(pool, n, [&](size_t begin, size_t end) { run(op, a + begin, c + begin, end - begin); });
+}
+
+/**
+ * @brief 按预先生成的广播方案计算 c = op(a, b)
+ */
+template <typename T, typename Op>
+void elementWiseBinary(ThreadPool *pool, const Op &op, const T *a, const T *b, T *c, const BroadcastPlan<2> &plan) {
+  static const auto run = element_wise::selectBinaryRun<T, Op>();
+  const size_t inner = plan.innerSize, n = plan.outerSize * inner;
+  const size_t strideA = plan.innerStrides[0], strideB = plan.innerStrides[1];
+  // 按元素数均匀分块，块的边界可以落在最内层运行的中间，因此完全连续的张量也能被并行
+  elementWiseParallel(pool, n, [&](size_t begin, size_t end) {
+    if (begin >= end) return;
+    for_each_broadcast_run(plan, begin / inner, (end + inner - 1) / inner,
+                           [&](size_t outOffset, const std::array<size_t, 2> &offsets, size_t len) {
+                             size_t lo = std::max(begin, outOffset), hi = std::min(end, outOffset + len);
+                             size_t skip = lo - outOffset;
+                             run(op, a + offsets[0] + skip * strideA, strideA, b + offsets[1] + skip * strideB,
+                                 strideB, c + lo, hi - lo);
+                           });
+  });
+}
+
+/**
+ * @brief 按 NumPy 广播规则计算 c = op(a, b)，c 的形状为 outShape
+ */
+template <typename T, typename Op>
+void elementWiseBinary(ThreadPool *pool, const Op &op, const T *a, const Shape &shapeA, const T *b,
+                       const Shape &shapeB, T *c, const Shape &outShape) {
+  elementWiseBinary(pool, op, a, b, c, make_broadcast_plan<2>(outShape, {shapeA, shapeB}));
+}
+
+}  // namespace infini
+
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <cstddef>
+
+#include "core/common.h"
+#include "utils/thread_pool.h"
+
+namespace infini {
+
+/**
+ * @brief 单精度 GEMM 微内核：在寄存器中计算 C[mr x nr] (+)= packA[kc x mr] * packB[kc x nr]
+ * @param kc 本次累加的 k 维长度
+ * @param packA 按 mr 行打包的 A 面板，第 p 个 k 对应的 mr 个元素连续存放
+ * @param packB 按 nr 列打包的 B 面板，第 p 个 k 对应的 nr 个元素连续存放
+ * @param c 输出块的起始地址
+ * @param ldc 输出矩阵的行跨度
+ * @param accumulate 为 true 时累加到 c 中，否则直接覆盖 c
+ */
+using SgemmMicroKernel = void (*)(int kc, const float *packA, const float *packB, float *c, size_t ldc,
+                                  bool accumulate);
+
+/**
+ * @brief 一组微内核及其对应的寄存器分块（mr x nr）和缓存分块（mc/kc/nc）参数
+ */
+struct SgemmKernelInfo {
+  const char *name;
+  int mr, nr;      // 寄存器分块大小
+  int mc, kc, nc;  // 缓存分块大小，mc 是 mr 的整数倍，nc 是 nr 的整数倍
+  SgemmMicroKernel microKernel;
+};
+
+/**
+ * @brief 返回当前 CPU 可以执行的所有微内核，按指令集从低到高排列
+ */
+const vector<SgemmKernelInfo> &getSgemmKernels();
+
+/**
+ * @brief 返回启动时根据 CPUID 选出的最优微内核（列表中的最后一个）
+ */
+const SgemmKernelInfo &getSgemmKernel();
+
+/**
+ * @brief 返回把 [k x n] 的 B 矩阵整体预打包为微内核面板格式后所需的元素个数
+ */
+size_t sgemmPackedBSize(const SgemmKernelInfo &info, int k, int n);
+
+/**
+ * @brief 将 op(B)[k x n] 整体预打包为 sgemm 使用的面板格式，常量权重只需要在编译期打包一次。
+ * 打包结果按 nc 列块依次存放，每个列块内再按 kc 行块依次存放
+ * @param packed 输出缓冲，大小至少为 sgemmPackedBSize(info, k, n) 个元素
+ */
+void sgemmPackB(const SgemmKernelInfo &info, bool transB, int k, int n, const float *B, size_t ldb, float *packed);
+
+/**
+ * @brief 单精度矩阵乘 C[m x n] = op(A)[m x k] * op(B)[k x n]，所有矩阵均为行主序。
+ * transA/transB 为 true 时 A/B 按 [k x m]/[n x k] 存放，打包时直接按转置方式读取，不会生成转置后的拷贝
+ * @param info 使用的微内核及分块参数
+ * @param lda/ldb/ldc 各矩阵在内存中的行跨度（以元素为单位）
+ * @param packedB 如果不为空，则是 sgemmPackB 预打包好的 B，计算时跳过 B 的打包，此时不会读取 B
+ */
+void sgemm(const SgemmKernelInfo &info, bool transA, bool transB, int m, int n, int k, const float *A, size_t lda,
+           const float *B, size_t ldb, float *C, size_t ldc, const float *packedB = nullptr);
+
+/**
+ * @brief 批量单精度矩阵乘，batch 维按照 NumPy 规则广播，广播的操作数不会被拷贝。
+ * 计算会按照 batch、M 分块和 N 分块划分给多个线程：batch 足够多时只按 batch 划分，
+ * 否则再把每个矩阵切成若干个 M x N 的子块，使小 batch 大矩阵和大 batch 小矩阵都能用满所有核心
+ * @param batchShape 输出张量的 batch 维度（最后两维之前的所有维度）
+ * @param stridesA/stridesB A/B 在每个 batch 维上的跨度（以元素为单位），被广播的维度跨度为 0
+ * @param C 输出张量，各个矩阵连续存放，行跨度为 n
+ * @param packedB 如果不为空，则是 B 中每个矩阵依次调用 sgemmPackB 得到的预打包数据，
+ * 此时只沿 batch 和 M 划分任务，各个线程共享同一份打包好的 B
+ * @param pool 执行子任务的线程池，为空时在当前线程计算
+ */
+void sgemmBatched(const SgemmKernelInfo &info, bool transA, bool transB, int m, int n, int k,
+                  const vector<int> &batchShape, const vector<size_t> &stridesA, const vector<size_t> &stridesB,
+                  const float *A, const float *B, float *C, const float *packedB = nullptr,
+                  ThreadPool *pool = nullptr);
+
+/**
+ * @brief 计算矩阵乘的输入在输出每个 batch 维上的跨度（以元素为单位），秩较低或该维为 1 的输入跨度为 0
+ * @param batchShape 输出张量的 batch 维度
+ * @param dims 输入张量的完整形状（最后两维为矩阵）
+ * @param matrixSize 输入中单个矩阵的元素个数
+ */
+vector<size_t> getMatmulBatchStrides(const vector<int> &batchShape, const vector<int> &dims, size_t matrixSize);
+
+/**
+ * @brief 将单个 m x n 的矩阵划分为 mTiles x nTiles 个子块分给多个线程，使子块数接近 parts，
+ * 且子块的形状尽量接近正方形（每个子块至少 mr 行、nr 列）
+ */
+void partitionMatrix(int parts, int m, int n, int mr, int nr, int &mTiles, int &nTiles);
+
+/**
+ * @brief 根据 batch 维度和每个维度上的跨度，计算每个 batch 的起始偏移量
+ */
+vector<size_t> getBatchOffsets(const vector<int> &batchShape, const vector<size_t> &strides);
+
+}  // namespace infini
+
+#endif
@@ -0,0 +1,75 @@
+#pragma once
+#ifndef QGEMM_H
+#define QGEMM_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/common.h"
+#include "utils/thread_pool.h"
+
+namespace infini {
+
+/**
+ * @brief int8 GEMM 微内核：计算 tile[mr x nr] = packA[mr x kq*4] * packB[kq*4 x nr]，结果为 int32。
+ * A 为无符号 8 位整数，B 为有符号 8 位整数，k 维按 4 个一组打包，与 VNNI 的点积指令（vpdpbusd）一致
+ * @param kq k 维按 4 对齐后的组数
+ * @param packA 按 mr 行打包的 A 面板，每组中第 i 行的 4 个字节连续存放
+ * @param packB 按 nr 列打包的 B 面板，每组中第 j 列的 4 个字节连续存放
+ * @param tile 输出的 mr x nr 的 int32 结果，行跨度为 nr
+ */
+using QgemmMicroKernel = void (*)(int kq, const uint8_t *packA, const int8_t *packB, int32_t *tile);
+
+struct QgemmKernelInfo {
+  const char *name;
+  int mr, nr;  // 寄存器分块大小
+  QgemmMicroKernel microKernel;
+};
+
+/**
+ * @brief 量化参数：real = scale * (q - zeroPoint)。A 只支持按张量量化，
+ * B 支持按张量（perChannel 为 false，只读取下标 0）或按输出通道（长度为 n）量化
+ */
+struct QgemmQuantParams {
+  float scaleA;
+  int32_t zeroPointA;
+  const float *scaleB;
+  const int32_t *zeroPointB;
+  bool perChannel;
+};
+
+/**
+ * @brief 返回当前 CPU 可以执行的所有 int8 微内核，按指令集从低到高排列
+ */
+const vector<QgemmKernelInfo> &getQgemmKernels();
+
+/**
+ * @brief 返回启动时根据 CPUID 选出的最优 int8 微内核
+ */
+const QgemmKernelInfo &getQgemmKernel();
+
+/**
+ * @brief 返回把 [k x n] 的 int8 B 矩阵预打包后所需的字节数（包括每列的累加和）
+ */
+size_t qgemmPackedBSize(const QgemmKernelInfo &info, int k, int n);
+
+/**
+ * @brief 将 op(B)[k x n] 预打包为 VNNI 面板格式，并在末尾保存每一列的累加和，用于在尾处理中扣除零点
+ */
+void qgemmPackB(const QgemmKernelInfo &info, bool transB, int k, int n, const int8_t *B, size_t ldb, void *packed);
+
+/**
+ * @brief 批量量化矩阵乘 C = scaleA * scaleB * (op(A) - zeroPointA) * (op(B) - zeroPointB)，
+ * 使用 int32 累加，在尾处理中反量化为 float32。batch 维的广播方式与 sgemmBatched 相同
+ * @param aSigned A 为 int8 时为 true（打包时加上 128 转换为 uint8，并相应地调整零点），为 uint8 时为 false
+ * @param packedB 如果不为空，则是 B 中每个矩阵依次调用 qgemmPackB 得到的预打包数据
+ * @param pool 执行子任务的线程池，为空时在当前线程计算
+ */
+void qgemmBatched(const QgemmKernelInfo &info, bool transA, bool transB, int m, int n, int k,
+                  const vector<int> &batchShape, const vector<size_t> &stridesA, const vector<size_t> &stridesB,
+                  const void *A, bool aSigned, const int8_t *B, float *C, const QgemmQuantParams &params,
+                  const void *packedB = nullptr, ThreadPool *pool = nullptr);
+
+}  // namespace infini
+
+#endif
@@ -28,5 +28,7 @@ class ConcatObj : public OperatorObj {
     int numInputs() const override { return inputs.size(); }
     int numOutputs() const override { return 1; }
     int getDim() const { return dim; }
+    double getFlops() const override { return 0; }
+    string getTuningKey() const override { return OperatorObj::getTuningKey() + "dim=" + std::to_string(dim); }
 };
 } // namespace infini
@@ -28,6 +28,8 @@ namespace infini
     std::string toString() const override;
     int numInputs() const override { return 2; }
     int numOutputs() const override { return 1; }
+    // 与输出形状相同（没有被广播）的输入可以原地计算
+    vector<int> getInplaceInputs() const override;
     };
 
 #define DEFINE_ELEMENT_WISE_OBJ(prefix, type)                    \
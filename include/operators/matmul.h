@@ -19,8 +19,9 @@ class MatmulObj : public OperatorObj {
  public:
   /**
    * @brief Matmul operator with batch broadcast and tensor transpose
-   * supports. Only one tensor with singe batch can be broadcasted due to the
-   * BLAS interface restriction. Tranpose indicates whether the last two
+   * supports. All dimensions before the last two are batch dimensions and are
+   * broadcasted bidirectionally following the NumPy rules, so the two inputs
+   * may have different ranks. Tranpose indicates whether the last two
    * dimensions should be transposed before Matmul and does not affect other
    * leading dimensions.
    *
@@ -52,6 +53,53 @@ class MatmulObj : public OperatorObj {
   int getM() const { return m; }
   int getN() const { return n; }
   int getK() const { return k; }
+
+  // 每个输出元素做 k 次乘加
+  double getFlops() const override { return 2.0 * k * outputs[0]->size(); }
+  string getTuningKey() const override {
+    return OperatorObj::getTuningKey() + (transA ? "A^T" : "") + (transB ? "B^T" : "");
+  }
+
+ protected:
+  /**
+   * @brief 供派生的矩阵乘算子使用，不会调用 checkValid，由派生类在构造完成后自行检查
+   */
+  MatmulObj(OpType type, GraphObj *graph, TensorVec inputs, Tensor C, bool transA, bool transB);
+};
+
+/**
+ * @brief Quantized matrix multiplication. A is an Int8 or UInt8 activation
+ * and B is an Int8 weight, real = scale * (q - zeroPoint). A is quantized per
+ * tensor while B can be quantized per tensor or per output channel (one
+ * scale/zero point for each of the n columns). The product is accumulated in
+ * int32 and dequantized to Float32 in the epilogue. Integer inputs can be
+ * produced by a Cast, e.g. CastType::Float2Int8.
+ */
+class QuantizedMatmulObj : public MatmulObj {
+ private:
+  float scaleA;
+  int32_t zeroPointA;
+  vector<float> scaleB;
+  vector<int32_t> zeroPointB;
+
+ public:
+  /**
+   * @param scaleB Scales of B, with 1 (per tensor) or n (per channel) elements.
+   * @param zeroPointB Zero points of B, with the same length as scaleB.
+   */
+  QuantizedMatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C, float scaleA, int32_t zeroPointA,
+                     vector<float> scaleB, vector<int32_t> zeroPointB, bool transA = false, bool transB = false);
+  OP_CLONE(QuantizedMatmulObj);
+
+  std::string toString() const override;
+  optional<vector<Shape>> inferShape(const TensorVec &inputs) override;
+  vector<DataType> inferDataType(const TensorVec &inputs) const override;
+
+  float getScaleA() const { return scaleA; }
+  int32_t getZeroPointA() const { return zeroPointA; }
+  const vector<float> &getScaleB() const { return scaleB; }
+  const vector<int32_t> &getZeroPointB() const { return zeroPointB; }
+  bool isPerChannel() const { return scaleB.size() > 1; }
 };
 
 }  // namespace infini
\ No newline at end of file
@@ -23,6 +23,8 @@ class TransposeObj : public OperatorObj {
   int numInputs() const override { return 1; }
   int numOutputs() const override { return 1; }
   std::vector<int> getPermute() const { return transposePermute; }
+  double getFlops() const override { return 0; }
+  string getTuningKey() const override { return OperatorObj::getTuningKey() + vecToString(transposePermute); }
 
  private:
   vector<int> transposePermute;
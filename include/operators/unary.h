@@ -24,6 +24,7 @@ namespace infini
     std::string toString() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    vector<int> getInplaceInputs() const override { return {0}; }
   };
 
   /**
@@ -42,6 +43,7 @@ namespace infini
     std::optional<float> getMax() const { return maxValue; };
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    vector<int> getInplaceInputs() const override { return {0}; }
 
   private:
     std::optional<float> minValue, maxValue;
@@ -91,6 +93,8 @@ namespace infini
     DataType getOutputDataType() const;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    // 只有输入输出元素宽度相同的转换才能原地计算
+    vector<int> getInplaceInputs() const override;
 
   private:
     CastType castType;
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef CPU_INFO_H
+#define CPU_INFO_H
+
+#include <cstddef>
+#include <string>
+
+namespace infini {
+
+/**
+ * @brief 运行时通过 CPUID/XGETBV 探测到的 CPU 指令集特性（已确认操作系统会保存对应的寄存器状态）
+ */
+struct CpuFeatures {
+  bool sse41 = false;
+  bool avx = false;
+  bool avx2 = false;
+  bool fma = false;
+  bool f16c = false;
+  bool avx512f = false;
+  bool avx512bw = false;
+  bool avx512vl = false;
+  bool avx512vnni = false;
+  bool avx512bf16 = false;
+};
+
+/**
+ * @brief 获取当前 CPU 支持的指令集特性，只在第一次调用时探测一次
+ * @return const CpuFeatures& 探测结果
+ */
+const CpuFeatures &getCpuFeatures();
+
+/**
+ * @brief 获取最后一级缓存（通常是 L3）的字节数，无法探测时返回 8MB
+ */
+size_t getLastLevelCacheSize();
+
+/**
+ * @brief 返回标识当前 CPU 的字符串：处理器型号和探测到的指令集，用于区分不同机器上的调优结果
+ */
+const std::string &getCpuSignature();
+
+}  // namespace infini
+
+#endif
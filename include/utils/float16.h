@@ -0,0 +1,83 @@
+#pragma once
+#ifndef FLOAT16_H
+#define FLOAT16_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace infini {
+
+/**
+ * 16 位浮点数与 float32 之间的软件转换，结果与 x86 的转换指令逐位一致：
+ *   - float32 -> float16 与 F16C 的 vcvtps2ph（就近舍入到偶数）一致
+ *   - float16 -> float32 与 F16C 的 vcvtph2ps 一致
+ *   - float32 -> bfloat16 与 AVX512_BF16 的 vcvtneps2bf16 一致（就近舍入到偶数，非规格化数视为 0）
+ * NaN 转换后都变为 quiet NaN，并保留符号位和尽可能多的高位 payload
+ */
+
+inline uint32_t fp32ToBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline float bitsToFp32(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+inline uint16_t fp32ToFp16(float value) {
+  uint32_t x = fp32ToBits(value);
+  const uint16_t sign = (x >> 16) & 0x8000;
+  x &= 0x7fffffff;
+  if (x >= 0x7f800000)  // Inf 或 NaN
+    return sign | 0x7c00 | (x > 0x7f800000 ? 0x200 | ((x >> 13) & 0x3ff) : 0);
+  if (x >= 0x477ff000)  // 不小于 65520 的值舍入后溢出为 Inf
+    return sign | 0x7c00;
+  if (x < 0x38800000) {  // 结果是非规格化数或 0
+    if (x < 0x33000000) return sign;  // 不大于 2^-25，舍入为 0
+    const uint32_t exp = x >> 23, shift = 126 - exp;
+    const uint32_t mantissa = (x & 0x7fffff) | 0x800000;
+    uint32_t h = mantissa >> shift, rest = mantissa & ((1u << shift) - 1), half = 1u << (shift - 1);
+    if (rest > half || (rest == half && (h & 1))) ++h;
+    return sign | h;
+  }
+  // 规格化数：指数的偏置从 127 改为 15，尾数保留高 10 位，进位可以自然地进入指数
+  uint32_t h = (x - 0x38000000) >> 13, rest = x & 0x1fff;
+  if (rest > 0x1000 || (rest == 0x1000 && (h & 1))) ++h;
+  return sign | h;
+}
+
+inline float fp16ToFp32(uint16_t h) {
+  const uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+  uint32_t exp = (h >> 10) & 0x1f, mantissa = h & 0x3ff;
+  if (exp == 0x1f)  // Inf 或 NaN
+    return bitsToFp32(sign | 0x7f800000 | (mantissa ? (mantissa | 0x200) << 13 : 0));
+  if (exp == 0) {
+    if (mantissa == 0) return bitsToFp32(sign);
+    // 非规格化数在 float32 中可以表示为规格化数
+    exp = 113;
+    while (!(mantissa & 0x400)) {
+      mantissa <<= 1;
+      --exp;
+    }
+    return bitsToFp32(sign | exp << 23 | (mantissa & 0x3ff) << 13);
+  }
+  return bitsToFp32(sign | (exp + 112) << 23 | mantissa << 13);
+}
+
+inline uint16_t fp32ToBf16(float value) {
+  uint32_t x = fp32ToBits(value);
+  if ((x & 0x7fffffff) > 0x7f800000)  // NaN
+    return (x >> 16) | 0x40;
+  if ((x & 0x7f800000) == 0)  // 0 和非规格化数
+    return (x >> 16) & 0x8000;
+  return (x + 0x7fff + ((x >> 16) & 1)) >> 16;
+}
+
+inline float bf16ToFp32(uint16_t h) { return bitsToFp32((uint32_t)h << 16); }
+
+}  // namespace infini
+
+#endif
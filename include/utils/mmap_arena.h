@@ -0,0 +1,64 @@
+#pragma once
+#ifndef MMAP_ARENA_H
+#define MMAP_ARENA_H
+
+#include <cstddef>
+
+namespace infini {
+
+/**
+ * @brief 用 mmap 分配的内存使用的页面
+ */
+enum class HugePageMode {
+  None,         // 普通的 4 KiB 页面
+  Transparent,  // 起始地址按大页对齐并 madvise(MADV_HUGEPAGE)，由内核的透明大页合并
+  Explicit,     // MAP_HUGETLB 使用预留的大页，没有可用的大页时退回 Transparent
+};
+
+/**
+ * @brief 运行时分配大块内存（计算图的内存、执行上下文的内存）的方式
+ */
+struct MmapArenaConfig {
+  bool enable = false;  // 为 false 时使用 aligned_alloc
+  HugePageMode hugePages = HugePageMode::Transparent;
+  int numaNode = -1;                // 用 mbind 把内存绑定到该 NUMA 节点，-1 表示不绑定
+  bool parallelFirstTouch = true;   // 分配后由线程池的线程分块写入每一页，使页面分配在使用它的线程所在的节点
+  size_t minSize = size_t(1) << 21;  // 小于该大小的分配仍然使用 aligned_alloc
+};
+
+/**
+ * @brief 一段 mmap 得到的内存
+ */
+struct MmapRegion {
+  void *ptr = nullptr;
+  size_t length = 0;        // 映射的长度，释放时使用
+  bool hugePages = false;   // 是否使用了 MAP_HUGETLB，或者成功 madvise(MADV_HUGEPAGE) 并且透明大页已开启
+  bool numaBound = false;   // 是否成功绑定到指定的 NUMA 节点
+};
+
+/**
+ * @brief 返回系统的默认大页大小（/proc/meminfo 中的 Hugepagesize），读取失败时为 2 MiB
+ */
+size_t getHugePageSize();
+
+/**
+ * @brief 返回内核是否会为 madvise(MADV_HUGEPAGE) 的区域使用透明大页：
+ * /sys/kernel/mm/transparent_hugepage/enabled 选中 always 或 madvise。
+ * 设置为 never 时 madvise 仍然成功，但不会使用大页
+ */
+bool transparentHugePagesEnabled();
+
+/**
+ * @brief 按 config 用 mmap 分配至少 size 字节、起始地址按 alignment 对齐的内存，内容为 0。
+ * 页面在第一次写入时才实际分配；映射失败时返回的 ptr 为空
+ */
+MmapRegion mmapArena(size_t size, size_t alignment, const MmapArenaConfig &config);
+
+/**
+ * @brief 释放 mmapArena 分配的内存
+ */
+void munmapArena(const MmapRegion &region);
+
+}  // namespace infini
+
+#endif
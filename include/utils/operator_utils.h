@@ -2,6 +2,7 @@
 #ifndef OPERATOR_UTIL_H
 #define OPERATOR_UTIL_H
 
+#include <array>
 #include <numeric>
 
 #include "core/operator.h"
@@ -24,6 +25,113 @@ size_t delocate_index(const Shape &shapeIndex, const Shape &shape, const Shape &
 // Convert KernelAttrs to a string representation
 std::string get_kernel_attrs_str(const KernelAttrs &kernelAttrs);
 
+/**
+ * @brief N 个输入广播到同一个输出时的遍历方案。
+ * 输出中为 1 的维度会被去掉，所有输入广播状态一致的相邻维度会被合并，
+ * 最后一维作为最内层的连续运行，输入在其上的跨度只可能是 1（连续）或 0（标量广播）
+ */
+template <size_t N>
+struct BroadcastPlan {
+  Shape shape;                             // 合并后的输出形状，至少有一维
+  std::array<vector<size_t>, N> strides;   // 每个输入在合并后各维上的跨度，被广播的维度为 0
+  size_t innerSize = 1;                    // 最内层连续运行的长度，即 shape.back()
+  size_t outerSize = 1;                    // 最内层之外所有维度的乘积
+  std::array<size_t, N> innerStrides{};    // 每个输入在最内层上的跨度（1 或 0）
+};
+
+/**
+ * @brief 根据输出形状和各个输入的形状生成广播遍历方案
+ * @param outShape 广播后的输出形状
+ * @param inputShapes 各个输入的形状（可以比输出的秩低，按右对齐广播）
+ */
+template <size_t N>
+BroadcastPlan<N> make_broadcast_plan(const Shape &outShape, const std::array<Shape, N> &inputShapes) {
+  const size_t rank = outShape.size();
+  // 1. 把输入右对齐补齐到输出的秩，同时去掉输出中为 1 的维度
+  Shape shape;
+  std::array<Shape, N> dims;
+  for (size_t d = 0; d < rank; ++d) {
+    if (outShape[d] == 1) continue;
+    shape.push_back(outShape[d]);
+    for (size_t i = 0; i < N; ++i) {
+      const auto &in = inputShapes[i];
+      IT_ASSERT(in.size() <= rank);
+      int offset = rank - in.size();
+      int dim = (int)d >= offset ? in[d - offset] : 1;
+      IT_ASSERT(dim == 1 || dim == outShape[d]);
+      dims[i].push_back(dim);
+    }
+  }
+  if (shape.empty()) {
+    shape.push_back(1);
+    for (auto &dim : dims) dim.push_back(1);
+  }
+
+  // 2. 所有输入在相邻两维上是否被广播的状态都相同时，可以把这两维合并为一维
+  BroadcastPlan<N> plan;
+  plan.shape.push_back(shape[0]);
+  std::array<Shape, N> merged;
+  for (size_t i = 0; i < N; ++i) merged[i].push_back(dims[i][0]);
+  for (size_t d = 1; d < shape.size(); ++d) {
+    bool canMerge = true;
+    for (size_t i = 0; i < N; ++i) canMerge &= (dims[i][d] == 1) == (merged[i].back() == 1);
+    if (canMerge) {
+      plan.shape.back() *= shape[d];
+      for (size_t i = 0; i < N; ++i) merged[i].back() *= dims[i][d];
+    } else {
+      plan.shape.push_back(shape[d]);
+      for (size_t i = 0; i < N; ++i) merged[i].push_back(dims[i][d]);
+    }
+  }
+
+  // 3. 计算每个输入的跨度，被广播的维度跨度为 0
+  const size_t mergedRank = plan.shape.size();
+  for (size_t i = 0; i < N; ++i) {
+    plan.strides[i].assign(mergedRank, 0);
+    size_t stride = 1;
+    for (size_t d = mergedRank; d-- > 0;) {
+      if (merged[i][d] != 1) plan.strides[i][d] = stride;
+      stride *= merged[i][d];
+    }
+    plan.innerStrides[i] = plan.strides[i].back();
+  }
+  plan.innerSize = plan.shape.back();
+  plan.outerSize = 1;
+  for (size_t d = 0; d + 1 < mergedRank; ++d) plan.outerSize *= plan.shape[d];
+  return plan;
+}
+
+/**
+ * @brief 按照广播方案遍历输出中 [beginOuter, endOuter) 范围内的最内层运行，
+ * 只在开始时做一次除法定位，之后通过进位递增各输入的偏移量
+ * @param func 以 (输出偏移, 各输入偏移的数组, 运行长度) 调用，每次处理一整段最内层运行
+ */
+template <size_t N, typename F>
+void for_each_broadcast_run(const BroadcastPlan<N> &plan, size_t beginOuter, size_t endOuter, F &&func) {
+  if (beginOuter >= endOuter) return;
+  const int outerRank = (int)plan.shape.size() - 1;
+  // 定位起始运行在各个外层维度上的下标，并计算各输入的起始偏移
+  vector<size_t> index(outerRank, 0);
+  std::array<size_t, N> offsets{};
+  size_t rest = beginOuter;
+  for (int d = outerRank - 1; d >= 0; --d) {
+    index[d] = rest % plan.shape[d];
+    rest /= plan.shape[d];
+    for (size_t i = 0; i < N; ++i) offsets[i] += index[d] * plan.strides[i][d];
+  }
+  for (size_t outer = beginOuter; outer < endOuter; ++outer) {
+    func(outer * plan.innerSize, offsets, plan.innerSize);
+    for (int d = outerRank - 1; d >= 0; --d) {
+      if (++index[d] < (size_t)plan.shape[d]) {
+        for (size_t i = 0; i < N; ++i) offsets[i] += plan.strides[i][d];
+        break;
+      }
+      index[d] = 0;
+      for (size_t i = 0; i < N; ++i) offsets[i] -= plan.strides[i][d] * (plan.shape[d] - 1);
+    }
+  }
+}
+
 }  // namespace infini
 
 #endif
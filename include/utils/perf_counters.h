@@ -0,0 +1,105 @@
+#pragma once
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "utils/thread_pool.h"
+
+namespace infini {
+
+/**
+ * @brief 硬件性能计数器的种类
+ */
+enum class PerfEvent { Cycles, Instructions, CacheReferences, CacheMisses, Branches, BranchMisses, Count };
+
+constexpr size_t kNumPerfEvents = static_cast<size_t>(PerfEvent::Count);
+
+/**
+ * @brief 一段代码执行期间各个计数器的增量，不可用的计数器为 0
+ */
+struct PerfCounterValues {
+  std::array<uint64_t, kNumPerfEvents> values{};
+
+  uint64_t operator[](PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+  PerfCounterValues &operator+=(const PerfCounterValues &rhs) {
+    for (size_t i = 0; i < kNumPerfEvents; ++i) values[i] += rhs.values[i];
+    return *this;
+  }
+};
+
+/**
+ * @brief 用 Linux perf_event_open 统计当前线程在用户态的硬件事件（周期、指令、最后一级缓存访问与缺失、分支与分支预测失败）。
+ * 所有事件以第一个打开成功的事件为组长打开为一组（PERF_FORMAT_GROUP），一起调度、一次读取，
+ * 分时复用时所有计数来自同一段时间，按实际计数的时间比例缩放后 IPC 等比值仍然有意义。
+ * 没有权限、没有 PMU（例如部分虚拟机）或不是 Linux 时 isAvailable() 返回 false，读取结果全部为 0。
+ * 计数器只统计创建它的线程，需要在每个线程中各自创建（见 forCurrentThread）
+ */
+class PerfCounters {
+ private:
+  std::vector<int> fds;              // fds[0] 为组长
+  std::vector<PerfEvent> events;     // 与 fds 对应的事件，打开失败的事件不在其中
+  bool available = false;
+
+  PerfCounterValues read() const;
+
+ public:
+  PerfCounters();
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  /**
+   * @brief 是否至少有一个计数器打开成功
+   */
+  bool isAvailable() const { return available; }
+
+  /**
+   * @brief 返回从创建到现在的累计计数，两次调用的差就是这段时间内的计数
+   */
+  PerfCounterValues now() const { return read(); }
+
+  /**
+   * @brief 返回当前线程的计数器，每个线程第一次调用时创建
+   */
+  static PerfCounters &forCurrentThread();
+};
+
+/**
+ * @brief 统计一段代码在所有参与线程上的计数之和：调用线程在 start 和 stop 之间的计数，
+ * 加上期间它发起的 parallelFor 在线程池其他线程上执行任务的计数（通过 TaskObserver 汇总）
+ */
+class PerfCounterScope : public TaskObserver {
+ private:
+  std::mutex mutex;
+  PerfCounterValues total, started;
+  TaskObserver *previous = nullptr;
+
+ public:
+  /**
+   * @brief 开始统计，并把自己设为当前线程的观察者
+   */
+  void start();
+
+  /**
+   * @brief 结束统计，恢复之前的观察者，返回所有线程的计数之和
+   */
+  PerfCounterValues stop();
+
+  void begin() override;
+  void end() override;
+};
+
+/**
+ * @brief 返回 after - before
+ */
+PerfCounterValues operator-(const PerfCounterValues &after, const PerfCounterValues &before);
+
+}  // namespace infini
+
+#endif
@@ -0,0 +1,134 @@
+#pragma once
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace infini {
+
+/**
+ * @brief 线程池的配置
+ */
+struct ThreadPoolConfig {
+  int threads = 0;          // 并行计算使用的线程总数（包括调用线程），小于 1 时使用进程可用的 CPU 数
+  bool pinThreads = false;  // 是否把每个工作线程绑定到一个固定的 CPU 上
+  int spinMicroseconds = 50;  // 工作线程没有任务时先自旋等待的时间，之后再休眠；为 0 时直接休眠
+};
+
+/**
+ * @brief 返回当前进程可以使用的 CPU 数（考虑 CPU 亲和性掩码）
+ */
+int getAvailableCpuCount();
+
+/**
+ * @brief 观察 parallelFor 分给其他线程的任务：调用线程设置了观察者时，每个帮忙的线程在执行领取到的任务之前和之后
+ * 分别调用 begin 和 end（在该线程中调用，嵌套的 parallelFor 同样传递），用于把各个线程上的统计汇总到发起者
+ */
+class TaskObserver {
+ public:
+  virtual ~TaskObserver() = default;
+  virtual void begin() = 0;
+  virtual void end() = 0;
+};
+
+/**
+ * @brief 设置当前线程的观察者，返回之前的观察者（用于恢复）
+ */
+TaskObserver *setTaskObserver(TaskObserver *observer);
+
+/**
+ * @brief 返回当前线程的观察者，没有时为空
+ */
+TaskObserver *getTaskObserver();
+
+/**
+ * @brief 常驻的工作窃取（work-stealing）线程池：每个工作线程有自己的任务队列，
+ * 工作线程提交的任务放入自己队列的尾部并从尾部取出（后进先出，刚产生的数据还在缓存中），
+ * 自己的队列为空时从其他线程队列的头部窃取任务；外部线程提交的任务轮流放入各个队列。
+ * 线程池同时用于算子之间的并行调度（submit）和算子内部的并行计算（parallelFor）
+ */
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(const ThreadPoolConfig &config = {});
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * @brief 按新的配置重新启动工作线程，调用时不能有正在执行的任务
+   */
+  void configure(const ThreadPoolConfig &config);
+  const ThreadPoolConfig &getConfig() const { return config; }
+
+  /**
+   * @brief 返回 parallelFor 使用的线程总数（包括调用线程）
+   */
+  int getNumThreads() const { return numThreads; }
+
+  /**
+   * @brief 提交一个异步执行的任务，任务中抛出的异常需要由任务自己处理
+   */
+  void submit(Task task);
+
+  /**
+   * @brief 对 [0, tasks) 中的每个 t 调用一次 func(t) 并等待全部完成。调用线程也参与计算，
+   * 其余线程动态领取剩下的任务，因此可以在工作线程中嵌套调用而不会死锁。func 抛出的异常在调用线程中重新抛出。
+   * 调用线程设置了 TaskObserver 时，其他线程执行任务前后通知它
+   */
+  void parallelFor(size_t tasks, const std::function<void(size_t)> &func);
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void start();
+  void stop();
+  void workerLoop(int index);
+  bool tryPop(int index, Task &task);
+
+  ThreadPoolConfig config;
+  int numThreads = 1;
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<size_t> nextQueue{0};  // 外部线程提交时轮流选择的队列
+
+  // pending 为已提交但还没有被取走的任务数；没有任务的工作线程自旋一段时间后在 wakeup 上休眠
+  std::atomic<size_t> pending{0};
+  std::atomic<int> sleeping{0};
+  std::mutex sleepMutex;
+  std::condition_variable wakeup;
+  bool stopping = false;
+};
+
+/**
+ * @brief 在 pool 上执行 parallelFor，pool 为空时在当前线程依次执行
+ */
+inline void parallelFor(ThreadPool *pool, size_t tasks, const std::function<void(size_t)> &func) {
+  if (pool && tasks > 1) {
+    pool->parallelFor(tasks, func);
+  } else {
+    for (size_t t = 0; t < tasks; ++t) func(t);
+  }
+}
+
+/**
+ * @brief 返回 pool 中可用于并行计算的线程数，pool 为空时为 1
+ */
+inline int getNumThreads(const ThreadPool *pool) { return pool ? pool->getNumThreads() : 1; }
+
+}  // namespace infini
+
+#endif
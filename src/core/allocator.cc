@@ -7,11 +7,6 @@ Allocator::Allocator(Runtime runtime) : runtime(runtime) {
   used = 0;
   peak = 0;
   ptr = nullptr;
-
-  // 'alignment' defaults to sizeof(uint64_t), because it is the length of
-  // the longest data type currently supported by the DataType field of
-  // the tensor
-  alignment = sizeof(uint64_t);
 }
 
 Allocator::~Allocator() {
@@ -171,8 +166,9 @@ void *Allocator::getPtr() {
 }
 
 size_t Allocator::getAlignedSize(size_t size) {
-  // 计算小于等于 size 且是 alignment 整数倍的内存大小
-  return ((size - 1) / this->alignment + 1) * this->alignment;
+  // 计算大于等于 size 且是对齐字节数整数倍的内存大小，alloc 返回的偏移量因此也都是对齐的
+  const size_t alignment = runtime->getAlignment();
+  return ((size - 1) / alignment + 1) * alignment;
 }
 
 void Allocator::info() { std::cout << "Used memory: " << this->used << ", peak memory: " << this->peak << std::endl; }
@@ -0,0 +1,109 @@
+#include "core/async_runner.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "core/plan.h"
+
+namespace infini {
+
+AsyncRunner::~AsyncRunner() { stop(); }
+
+void AsyncRunner::configure(const AsyncConfig &newConfig) {
+  IT_ASSERT(newConfig.maxInFlight >= 1 && newConfig.queueCapacity >= 1);
+  // 执行线程要等待所有执行线程退出，包括它自己
+  IT_ASSERT(!isWorkerThread(), "AsyncRunner cannot be reconfigured from one of its worker threads");
+  stop();
+  std::lock_guard<std::mutex> lock(mutex);
+  config = newConfig;
+  stopping = false;
+}
+
+bool AsyncRunner::isWorkerThread() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return std::any_of(workers.begin(), workers.end(),
+                     [](const std::thread &worker) { return worker.get_id() == std::this_thread::get_id(); });
+}
+
+std::future<void> AsyncRunner::submit(const Plan &plan) { return enqueueWithFuture({plan, nullptr, nullptr}); }
+
+void AsyncRunner::submit(const Plan &plan, Callback done) { enqueue({plan, nullptr, std::move(done)}); }
+
+std::future<void> AsyncRunner::submit(const ExecutionContext &context) {
+  return enqueueWithFuture({nullptr, context, nullptr});
+}
+
+void AsyncRunner::submit(const ExecutionContext &context, Callback done) {
+  enqueue({nullptr, context, std::move(done)});
+}
+
+std::future<void> AsyncRunner::enqueueWithFuture(Request request) {
+  auto promise = std::make_shared<std::promise<void>>();
+  auto future = promise->get_future();
+  request.done = [promise](std::exception_ptr error) {
+    if (error)
+      promise->set_exception(error);
+    else
+      promise->set_value();
+  };
+  enqueue(std::move(request));
+  return future;
+}
+
+void AsyncRunner::enqueue(Request request) {
+  std::unique_lock<std::mutex> lock(mutex);
+  IT_ASSERT(!stopping);
+  if (workers.empty())
+    for (int i = 0; i < config.maxInFlight; ++i) workers.emplace_back([this] { workerLoop(); });
+  // 队列满时阻塞提交者，避免请求无限堆积
+  notFull.wait(lock, [&] { return requests.size() < config.queueCapacity; });
+  requests.push_back(std::move(request));
+  lock.unlock();
+  notEmpty.notify_one();
+}
+
+void AsyncRunner::workerLoop() {
+  while (true) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      notEmpty.wait(lock, [&] { return stopping || !requests.empty(); });
+      if (requests.empty()) return;  // stopping 并且没有剩余请求
+      request = std::move(requests.front());
+      requests.pop_front();
+    }
+    notFull.notify_one();
+
+    std::exception_ptr error;
+    try {
+      if (request.context)
+        runtime->run(request.context);
+      else
+        runtime->run(request.plan);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    if (!request.done) continue;
+    // 回调的异常没有调用者可以接收，抛出执行线程会终止进程，因此只打印出来
+    try {
+      request.done(error);
+    } catch (const std::exception &e) {
+      std::cerr << "Exception in async completion callback: " << e.what() << std::endl;
+    } catch (...) {
+      std::cerr << "Unknown exception in async completion callback" << std::endl;
+    }
+  }
+}
+
+void AsyncRunner::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  notEmpty.notify_all();
+  // 执行线程会先处理完队列中剩余的请求再退出
+  for (auto &worker : workers) worker.join();
+  workers.clear();
+}
+
+}  // namespace infini
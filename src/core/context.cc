@@ -0,0 +1,39 @@
+#include "core/context.h"
+
+namespace infini {
+
+ExecutionContextObj::ExecutionContextObj(Plan plan)
+    : plan(std::move(plan)), runtime(this->plan->getGraph()->getRuntime()) {
+  const auto &graph = this->plan->getGraph();
+  auto [base, size] = graph->getDataArena();
+  arena = runtime->alloc(size);
+
+  // 输入和中间结果按相同的偏移量放在上下文的内存中，权重使用计算图常驻的权重内存
+  for (auto &tensor : graph->getTensors()) {
+    auto ptr = tensor->getRawDataPtr<uint8_t *>();
+    if (!tensor->isWeight()) {
+      IT_ASSERT(ptr >= base && ptr + tensor->getBytes() <= base + size);
+      data[tensor.get()] = static_cast<uint8_t *>(arena) + (ptr - base);
+    } else {
+      data[tensor.get()] = ptr;
+    }
+  }
+
+  for (const auto &entry : this->plan->getEntries()) {
+    auto &in = inputs.emplace_back(), &out = outputs.emplace_back();
+    for (const auto &input : entry.op->getInputs()) in.push_back(data.at(input.get()));
+    for (const auto &output : entry.op->getOutputs()) out.push_back(data.at(output.get()));
+  }
+}
+
+ExecutionContextObj::~ExecutionContextObj() {
+  if (arena) runtime->dealloc(arena);
+}
+
+string ExecutionContextObj::toString() const {
+  std::ostringstream oss;
+  oss << "ExecutionContext " << guid << ", arena " << arena << ", " << plan->getEntries().size() << " entries";
+  return oss.str();
+}
+
+}  // namespace infini
@@ -4,6 +4,8 @@
 #include <numeric>
 #include <queue>
 
+#include "core/kernel.h"
+#include "operators/concat.h"
 #include "operators/matmul.h"
 #include "operators/transpose.h"
 
@@ -269,71 +271,327 @@ void GraphObj::shape_infer() {
   }
 }
 
-void GraphObj::dataMalloc() {
+void GraphObj::dataMalloc(bool concurrent) {
   // topological sorting first
   IT_ASSERT(topo_sort() == true);
 
+  concurrentMalloc = concurrent;
+  liveBytes.clear();
+  elidedOps.clear();
+  weightMalloc();
+  if (concurrent) {
+    auto offsets = planConcurrentOffsets();
+    for (auto &tensor : tensors)
+      if (!tensor->isWeight())
+        tensor->setDataBlob(
+          make_ref<BlobObj>(runtime, static_cast<uint8_t *>(allocator.getPtr()) + offsets[tensor.get()]));
+    allocator.info();
+    return;
+  }
+
   // =================================== 作业 ===================================
   // TODO：利用 allocator 给计算图分配内存
   // HINT: 获取分配好的内存指针后，可以调用 tensor 的 setDataBlob 函数给 tensor 绑定内存
   // =================================== 作业 ===================================
 
-  // 记录每个张量所分配内存地址的偏移量
-  std::unordered_map<TensorObj *, size_t> tensorAddrOffsets;
+  // 1. 按拓扑序计算每个缓冲的生命周期。原地计算时输出与输入共用一个缓冲；被消除的 Concat 的输入与输出共用一个缓冲，
+  //    缓冲从第一个输入生成时开始存活；图的输入从第一个算子开始存活，没有使用者的张量（图的输出）存活到最后一个算子；
+  //    权重不参与规划
+  const size_t lastStep = ops.empty() ? 0 : ops.size() - 1;
+  vector<LiveInterval> intervals;
+  std::unordered_map<TensorObj *, size_t> bufferOf;
+  auto views = planConcatViews();
+  // 放在其他张量中的张量以及包含它们的张量，后面的算子不能原地复用它们的内存（其他部分可能还要被读取）
+  std::unordered_set<TensorObj *> viewBuffers;
+  for (auto &[view, location] : views) {
+    viewBuffers.insert(view);
+    viewBuffers.insert(location.first);
+  }
 
-  // 记录每个输入张量被多少个算子使用（以在模拟分配时确定是否能释放该张量的内存）
+  // 记录每个输入张量还剩多少个算子使用（以确定当前算子是否是它最后的使用者）
   std::unordered_map<TensorObj *, size_t> inputUsedCount;
-
-  // 1. 遍历拓扑排序后的计算图中的所有算子，根据输入和输出张量的形状，模拟计算过程中内存的使用情况
-  //   - InfiniTensor 中输入和输出张量预先执行了内存的模拟 alloc，此处是否需要？
-  //     只需要给输入张量预分配内存即可，这样下面模拟时可以直接从第一个算子的输出开始，只执行 [为输出分配]-> [释放输入]
-
-  // 1.1 先遍历所有张量，为输入张量预分配内存，同时计算每个输入张量被多少算子使用
   for (auto &tensor : tensors) {
-    // 如果当前张量没有生成算子，即为输入张量，为其分配内存
-    if (tensor->getSource() == nullptr) {
-      tensorAddrOffsets[tensor.get()] = allocator.alloc(tensor->getBytes());
-    }
-    // 计算当前张量有多少个算子使用
-    if (tensor->getTargets().size() != 0) {
-      inputUsedCount[tensor.get()] = tensor->getTargets().size();
+    if (tensor->getSource() == nullptr && !tensor->isWeight()) {
+      bufferOf[tensor.get()] = intervals.size();
+      intervals.push_back({allocator.getAlignedSize(tensor->getBytes()), 0, tensor->getTargets().empty() ? lastStep : 0,
+                           runtime->getAlignment(tensor->getBytes())});
     }
+    if (tensor->getTargets().size() != 0) inputUsedCount[tensor.get()] = tensor->getTargets().size();
   }
-  
-  // 1.2 遍历算子执行模拟
-  for (auto &op : ops) {
-    // 获取算子的所有输出张量，执行内存分配
+
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto &op = ops[i];
+    auto inputs = op->getInputs();
     auto outputs = op->getOutputs();
+
+    // 如果算子支持原地计算，并且某个可复用的输入是中间结果（不是图的输入或输出）、
+    // 当前算子是它最后的使用者、大小与输出相同，则输出直接使用该输入的内存
+    TensorObj *inplaceInput = nullptr;
+    if (outputs.size() == 1 && !viewBuffers.count(outputs[0].get())) {
+      for (int k : op->getInplaceInputs()) {
+        auto input = inputs[k].get();
+        if (!input->getSource() || input->getBytes() != outputs[0]->getBytes() || viewBuffers.count(input)) continue;
+        size_t usesByOp = std::count(inputs.begin(), inputs.end(), inputs[k]);
+        if (inputUsedCount[input] == usesByOp) {
+          inplaceInput = input;
+          break;
+        }
+      }
+    }
+
     for (auto &output : outputs) {
-      tensorAddrOffsets[output.get()] = allocator.alloc(output->getBytes());
+      // 放在其他张量中的输出使用最外层张量的缓冲，由第一个生成的部分创建
+      auto view = views.find(output.get());
+      TensorObj *buffer = view != views.end() ? view->second.first : output.get();
+      if (inplaceInput) {
+        bufferOf[output.get()] = bufferOf.at(inplaceInput);
+      } else if (bufferOf.count(buffer)) {
+        bufferOf[output.get()] = bufferOf.at(buffer);
+      } else {
+        bufferOf[buffer] = bufferOf[output.get()] = intervals.size();
+        intervals.push_back({allocator.getAlignedSize(buffer->getBytes()), i, i, runtime->getAlignment(buffer->getBytes())});
+      }
+      auto &interval = intervals[bufferOf[output.get()]];
+      interval.end = std::max(interval.end, i);
+      if (output->getTargets().empty()) interval.end = lastStep;
     }
-    // 获取算子的所有输入张量，释放内存
-    auto inputs = op->getInputs();
     for (auto &input : inputs) {
-      // 先递减使用当前张量的算子个数
+      if (input->isWeight()) continue;
+      auto &interval = intervals[bufferOf.at(input.get())];
+      interval.end = std::max(interval.end, i);
       inputUsedCount[input.get()]--;
-      // 如果当前张量没有被任何算子使用，释放内存
-      if (inputUsedCount[input.get()] == 0) {
-        allocator.free(tensorAddrOffsets[input.get()], input->getBytes());
-        // 从记录张量的使用 map 中删除当前张量，提高后续的搜索效率
-        inputUsedCount.erase(input.get());
-      }
     }
   }
 
-  // 2. 根据模拟的结果，执行实际的内存分配（alloctor.getPtr），并将分配好的内存位置记录到对应张量的 data.ptr 中
+  // 2. 离线规划每个缓冲的偏移量，整块内存一次性从 allocator 中申请
+  memoryPlan = MemoryPlanner(exactPlanLimit).plan(intervals, ops.size());
+  liveBytes = MemoryPlanner::getLiveBytes(intervals, ops.size());
+  liveBytes.resize(ops.size());
+  size_t base = memoryPlan.size > 0 ? allocator.alloc(memoryPlan.size) : 0;
+
+  // 3. 执行实际的内存分配（alloctor.getPtr），并将分配好的内存位置记录到对应张量的 data.ptr 中
   for (auto &tensor : tensors) {
-    tensor->setDataBlob(
-        make_ref<BlobObj>(runtime, static_cast<uint8_t *>(allocator.getPtr()) + tensorAddrOffsets[tensor.get()]));
+    if (tensor->isWeight()) continue;
+    auto view = views.find(tensor.get());
+    size_t offset = base + memoryPlan.offsets[bufferOf.at(tensor.get())] + (view != views.end() ? view->second.second : 0);
+    tensor->setDataBlob(make_ref<BlobObj>(runtime, static_cast<uint8_t *>(allocator.getPtr()) + offset));
   }
 
   allocator.info();
 }
 
+std::unordered_map<TensorObj *, pair<TensorObj *, size_t>> GraphObj::planConcatViews() {
+  // 沿维度 dim 拼接时，如果 dim 之前的维度都是 1，每个输入就是输出中连续的一段，
+  // 生成输入的算子可以直接写到输出中对应的位置，省去 Concat 对所有数据的一次读和一次写
+  std::unordered_map<TensorObj *, pair<TensorObj *, size_t>> views;
+  if (!concatElimination) return views;
+  for (auto &op : ops) {
+    if (op->getOpType() != OpType::Concat) continue;
+    auto concat = as<ConcatObj>(op);
+    auto output = concat->getOutput();
+    const auto &dims = output->getDims();
+    if (std::any_of(dims.begin(), dims.begin() + concat->getDim(), [](int d) { return d != 1; })) continue;
+    // 每个输入都要是中间结果（图的输入和权重的内存由外部写入），并且只能放在一个位置
+    auto inputs = op->getInputs();
+    std::unordered_set<TensorObj *> unique;
+    if (!std::all_of(inputs.begin(), inputs.end(), [&](const Tensor &input) {
+          return input->getSource() && !input->isWeight() && !views.count(input.get()) &&
+                 unique.insert(input.get()).second;
+        }))
+      continue;
+    size_t offset = 0;
+    for (auto &input : inputs) {
+      views[input.get()] = {output.get(), offset};
+      offset += input->getBytes();
+    }
+    elidedOps.insert(op.get());
+  }
+
+  // 嵌套的 Concat：被消除的 Concat 的输出又放在外层 Concat 的输出中，偏移量累加到最外层张量
+  for (auto &[view, location] : views) {
+    for (auto outer = views.find(location.first); outer != views.end(); outer = views.find(location.first)) {
+      location.first = outer->second.first;
+      location.second += outer->second.second;
+    }
+  }
+  return views;
+}
+
+pair<uint8_t *, size_t> GraphObj::getDataArena() {
+  IT_ASSERT(allocator.isAllocated(), "dataMalloc must be called first");
+  return {static_cast<uint8_t *>(allocator.getPtr()), allocator.getPeak()};
+}
+
+pair<uint8_t *, size_t> GraphObj::getWeightArena() {
+  if (!weightAllocator.isAllocated()) return {nullptr, 0};
+  return {static_cast<uint8_t *>(weightAllocator.getPtr()), weightAllocator.getPeak()};
+}
+
+void GraphObj::weightMalloc() {
+  std::unordered_map<TensorObj *, size_t> offsets;
+  size_t size = 0;
+  for (auto &tensor : tensors) {
+    if (!tensor->isWeight()) continue;
+    IT_ASSERT(!tensor->getSource(), "Weight " + tensor->toString() + " must not be produced by an operator");
+    const size_t alignment = runtime->getAlignment(tensor->getBytes());
+    offsets[tensor.get()] = (size + alignment - 1) / alignment * alignment;
+    size = offsets[tensor.get()] + weightAllocator.getAlignedSize(tensor->getBytes());
+  }
+  if (offsets.empty()) return;
+  // 整块内存一次性从 weightAllocator 中申请，之后不再释放或复用
+  size_t base = size > 0 ? weightAllocator.alloc(size) : 0;
+  auto ptr = static_cast<uint8_t *>(weightAllocator.getPtr());
+  for (auto &[tensor, offset] : offsets) tensor->setDataBlob(make_ref<BlobObj>(runtime, ptr + base + offset));
+}
+
+std::unordered_map<TensorObj *, size_t> GraphObj::planConcurrentOffsets() {
+  // 按拓扑序模拟分配和释放的方法只适用于依次执行：一个张量在拓扑序中最后的使用者之后就被释放，
+  // 但拓扑序靠后的算子可能与该使用者同时执行。并行调度时两个张量能否共用内存取决于它们的生命周期
+  // 是否一定有先后：A 的所有使用者（生成算子和读取算子）都是 B 的生成算子的祖先时，B 一定在 A 用完之后才写入
+
+  // 1. 用位图记录每个算子的所有祖先
+  const size_t n = ops.size(), words = (n + 63) / 64;
+  std::unordered_map<OperatorObj *, size_t> index;
+  for (size_t i = 0; i < n; ++i) index[ops[i].get()] = i;
+  vector<vector<uint64_t>> ancestors(n, vector<uint64_t>(words, 0));
+  for (size_t i = 0; i < n; ++i)
+    for (auto &pred : ops[i]->getPredecessors()) {
+      size_t p = index.at(pred.get());
+      for (size_t w = 0; w < words; ++w) ancestors[i][w] |= ancestors[p][w];
+      ancestors[i][p / 64] |= uint64_t(1) << (p % 64);
+    }
+  auto isAncestor = [&](size_t a, size_t b) { return (ancestors[b][a / 64] >> (a % 64)) & 1; };
+
+  // 2. 把原地计算时共用内存的张量合并为一个缓冲，记录缓冲的生成算子（图的输入为 -1）和所有使用者
+  struct Buffer {
+    size_t bytes;
+    size_t alignment;
+    long root;
+    vector<size_t> users;
+    bool live = false;  // 包含图的输出，一直存活到计算结束
+    size_t offset = 0;
+  };
+  vector<Buffer> buffers;
+  std::unordered_map<TensorObj *, size_t> bufferOf;
+  for (auto &tensor : tensors)
+    if (!tensor->getSource() && !tensor->isWeight()) {
+      bufferOf[tensor.get()] = buffers.size();
+      buffers.push_back({allocator.getAlignedSize(tensor->getBytes()), runtime->getAlignment(tensor->getBytes()), -1, {},
+                         tensor->getTargets().empty()});
+    }
+  for (size_t i = 0; i < n; ++i) {
+    auto &op = ops[i];
+    auto inputs = op->getInputs();
+    auto outputs = op->getOutputs();
+    // 输入的其他读取算子都是当前算子的祖先时，当前算子是它最后的使用者，输出可以原地复用它的内存
+    TensorObj *inplaceInput = nullptr;
+    if (outputs.size() == 1) {
+      for (int k : op->getInplaceInputs()) {
+        auto input = inputs[k].get();
+        if (!input->getSource() || input->getBytes() != outputs[0]->getBytes()) continue;
+        auto targets = input->getTargets();
+        if (std::all_of(targets.begin(), targets.end(), [&](const Operator &target) {
+              return target == op || isAncestor(index.at(target.get()), i);
+            })) {
+          inplaceInput = input;
+          break;
+        }
+      }
+    }
+    for (auto &output : outputs) {
+      if (inplaceInput) {
+        bufferOf[output.get()] = bufferOf.at(inplaceInput);
+      } else {
+        bufferOf[output.get()] = buffers.size();
+        buffers.push_back(
+            {allocator.getAlignedSize(output->getBytes()), runtime->getAlignment(output->getBytes()), (long)i, {}});
+      }
+      auto &buffer = buffers[bufferOf[output.get()]];
+      buffer.users.push_back(i);
+      buffer.live = buffer.live || output->getTargets().empty();
+    }
+    for (auto &input : inputs)
+      if (!input->isWeight()) buffers[bufferOf.at(input.get())].users.push_back(i);
+  }
+
+  // a 的生命周期一定在 b 之前结束
+  auto before = [&](const Buffer &a, const Buffer &b) {
+    return !a.live && b.root >= 0 &&
+           std::all_of(a.users.begin(), a.users.end(), [&](size_t u) { return isAncestor(u, b.root); });
+  };
+
+  // 3. 按生成的先后依次放置每个缓冲：在生命周期可能重叠的已放置缓冲之间找到最低的空隙
+  size_t peak = 0;
+  for (size_t b = 0; b < buffers.size(); ++b) {
+    vector<pair<size_t, size_t>> occupied;
+    for (size_t a = 0; a < b; ++a)
+      if (!before(buffers[a], buffers[b]) && !before(buffers[b], buffers[a]))
+        occupied.emplace_back(buffers[a].offset, buffers[a].offset + buffers[a].bytes);
+    std::sort(occupied.begin(), occupied.end());
+    const size_t alignment = buffers[b].alignment;
+    size_t offset = 0;
+    for (auto &[begin, end] : occupied) {
+      if (offset + buffers[b].bytes <= begin) break;
+      offset = std::max(offset, (end + alignment - 1) / alignment * alignment);
+    }
+    buffers[b].offset = offset;
+    peak = std::max(peak, offset + buffers[b].bytes);
+  }
+
+  // 按拓扑序统计执行到每个算子时生命周期覆盖它的缓冲大小
+  liveBytes.assign(n, 0);
+  for (auto &buffer : buffers) {
+    if (buffer.users.empty()) continue;
+    size_t first = buffer.root >= 0 ? buffer.root : 0;
+    size_t last = buffer.live ? n - 1 : *std::max_element(buffer.users.begin(), buffer.users.end());
+    for (size_t i = first; i <= last; ++i) liveBytes[i] += buffer.bytes;
+  }
+
+  memoryPlan = MemoryPlan();
+  memoryPlan.strategy = "concurrent";
+  memoryPlan.size = peak;
+  memoryPlan.lowerBound = n ? *std::max_element(liveBytes.begin(), liveBytes.end()) : 0;
+
+  // 整块内存一次性从 allocator 中申请
+  size_t base = peak > 0 ? allocator.alloc(peak) : 0;
+  std::unordered_map<TensorObj *, size_t> offsets;
+  for (auto &[tensor, buffer] : bufferOf) offsets[tensor] = base + buffers[buffer].offset;
+  return offsets;
+}
+
+void GraphObj::prepackWeights() {
+  const auto &kernelRegistry = KernelRegistry::getInstance();
+  auto getKernel = [&](const Operator &op) {
+    return std::get<0>(kernelRegistry.getKernelItem(runtime->getDevice(), op));
+  };
+
+  // 第一次调用时模拟分配所有预打包缓冲，之后重复调用只重新打包到已有的缓冲中
+  if (!prepackAllocator.isAllocated()) {
+    vector<pair<Operator, size_t>> offsets;
+    for (auto &op : ops) {
+      size_t size = getKernel(op)->getPrepackSize(op, runtime.get());
+      if (size > 0) offsets.emplace_back(op, prepackAllocator.alloc(size));
+    }
+    if (offsets.empty()) return;
+    auto base = static_cast<uint8_t *>(prepackAllocator.getPtr());
+    for (auto &[op, offset] : offsets) op->setPrepackedData(make_ref<BlobObj>(runtime, base + offset));
+  }
+
+  for (auto &op : ops) {
+    if (auto &blob = op->getPrepackedData()) getKernel(op)->prepack(op, runtime.get(), blob->getPtr<void *>());
+  }
+}
+
 Tensor GraphObj::addTensor(Shape dim, DataType dtype) {
   return tensors.emplace_back(make_ref<TensorObj>(dim, dtype, runtime));
 }
 
+Tensor GraphObj::addWeight(Shape dim, DataType dtype) {
+  auto tensor = addTensor(dim, dtype);
+  tensor->setWeight(true);
+  return tensor;
+}
+
 Tensor GraphObj::addTensor(const Tensor &tensor) {
   IT_ASSERT(tensor->getRuntime() == runtime, std::string("Tensor runtime mismatch: cannot add a tenosr in ") +
                                                  tensor->getRuntime()->toString() + " to " + runtime->toString());
@@ -0,0 +1,202 @@
+#include "core/memory_planner.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+namespace infini {
+
+string MemoryPlan::toString() const {
+  std::ostringstream oss;
+  oss << strategy << ": " << size << " bytes, lower bound " << lowerBound << " bytes (+" << std::fixed
+      << std::setprecision(2) << getGap() * 100 << "%)";
+  return oss.str();
+}
+
+static size_t alignUp(size_t offset, size_t alignment) { return (offset + alignment - 1) / alignment * alignment; }
+
+static bool overlaps(const LiveInterval &a, const LiveInterval &b) { return a.begin <= b.end && b.begin <= a.end; }
+
+// 所有生命周期都要落在 [0, numSteps) 中
+static size_t countSteps(const vector<LiveInterval> &intervals, size_t numSteps) {
+  for (auto &interval : intervals) numSteps = std::max(numSteps, interval.end + 1);
+  return numSteps;
+}
+
+vector<size_t> MemoryPlanner::getLiveBytes(const vector<LiveInterval> &intervals, size_t numSteps) {
+  // 差分后求前缀和
+  vector<size_t> live(countSteps(intervals, numSteps) + 1, 0);
+  for (auto &interval : intervals) {
+    live[interval.begin] += interval.bytes;
+    live[interval.end + 1] -= interval.bytes;
+  }
+  std::partial_sum(live.begin(), live.end(), live.begin());
+  live.pop_back();
+  return live;
+}
+
+/**
+ * @brief 在与第 b 块生命周期重叠的已放置内存块之间找到能放下它的最小空隙，没有时放在这些内存块的最上方
+ */
+static size_t bestFit(const vector<LiveInterval> &intervals, const vector<size_t> &offsets,
+                      const vector<bool> &placed, size_t b) {
+  vector<pair<size_t, size_t>> occupied;
+  for (size_t a = 0; a < intervals.size(); ++a)
+    if (placed[a] && intervals[a].bytes && overlaps(intervals[a], intervals[b]))
+      occupied.emplace_back(offsets[a], offsets[a] + intervals[a].bytes);
+  std::sort(occupied.begin(), occupied.end());
+  const size_t alignment = intervals[b].alignment;
+  size_t top = 0, best = 0, bestGap = std::numeric_limits<size_t>::max();
+  for (auto &[begin, end] : occupied) {
+    size_t offset = alignUp(top, alignment);
+    if (offset + intervals[b].bytes <= begin && begin - offset < bestGap) {
+      best = offset;
+      bestGap = begin - offset;
+    }
+    top = std::max(top, end);
+  }
+  return bestGap != std::numeric_limits<size_t>::max() ? best : alignUp(top, alignment);
+}
+
+/**
+ * @brief 按 order 的顺序依次放置内存块
+ */
+static MemoryPlan placeInOrder(const vector<LiveInterval> &intervals, size_t numSteps, const vector<size_t> &order,
+                               const string &strategy) {
+  MemoryPlan plan;
+  plan.strategy = strategy;
+  plan.offsets.assign(intervals.size(), 0);
+  vector<bool> placed(intervals.size(), false);
+  for (size_t b : order) {
+    if (!intervals[b].bytes) continue;
+    plan.offsets[b] = bestFit(intervals, plan.offsets, placed, b);
+    placed[b] = true;
+    plan.size = std::max(plan.size, plan.offsets[b] + intervals[b].bytes);
+  }
+  auto live = MemoryPlanner::getLiveBytes(intervals, numSteps);
+  plan.lowerBound = live.empty() ? 0 : *std::max_element(live.begin(), live.end());
+  return plan;
+}
+
+MemoryPlan MemoryPlanner::greedyBySize(const vector<LiveInterval> &intervals, size_t numSteps) {
+  vector<size_t> order(intervals.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return intervals[a].bytes > intervals[b].bytes; });
+  return placeInOrder(intervals, numSteps, order, "greedy-by-size");
+}
+
+MemoryPlan MemoryPlanner::greedyByBreadth(const vector<LiveInterval> &intervals, size_t numSteps) {
+  auto live = getLiveBytes(intervals, numSteps);
+  vector<size_t> steps(live.size());
+  std::iota(steps.begin(), steps.end(), 0);
+  std::stable_sort(steps.begin(), steps.end(), [&](size_t a, size_t b) { return live[a] > live[b]; });
+
+  vector<size_t> order;
+  vector<bool> queued(intervals.size(), false);
+  for (size_t step : steps) {
+    vector<size_t> alive;
+    for (size_t b = 0; b < intervals.size(); ++b)
+      if (!queued[b] && intervals[b].begin <= step && step <= intervals[b].end) alive.push_back(b);
+    std::stable_sort(alive.begin(), alive.end(),
+                     [&](size_t a, size_t b) { return intervals[a].bytes > intervals[b].bytes; });
+    for (size_t b : alive) {
+      queued[b] = true;
+      order.push_back(b);
+    }
+  }
+  return placeInOrder(intervals, numSteps, order, "greedy-by-breadth");
+}
+
+namespace {
+/**
+ * @brief 精确搜索的状态。按偏移量从小到大放置内存块（偏移量相同时按下标），
+ * 每块的候选位置为 0 和已放置的重叠内存块的末尾（按该块的对齐向上取整）
+ */
+struct ExactSearch {
+  const vector<LiveInterval> &intervals;
+  vector<size_t> offsets, bestOffsets;
+  vector<bool> placed;
+  size_t best, lowerBound;
+  size_t nodes = 0, budget;
+
+  void search(size_t remaining, size_t lastOffset, size_t lastIndex, size_t top) {
+    if (best == lowerBound || ++nodes > budget) return;
+    if (remaining == 0) {
+      if (top < best) {
+        best = top;
+        bestOffsets = offsets;
+      }
+      return;
+    }
+    // 剩余的每一块都不会低于 lastOffset
+    for (size_t b = 0; b < intervals.size(); ++b)
+      if (!placed[b] && alignUp(lastOffset, intervals[b].alignment) + intervals[b].bytes >= best) return;
+
+    for (size_t b = 0; b < intervals.size(); ++b) {
+      if (placed[b]) continue;
+      const auto &interval = intervals[b];
+      vector<size_t> candidates{0};
+      for (size_t a = 0; a < intervals.size(); ++a)
+        if (placed[a] && overlaps(intervals[a], interval))
+          candidates.push_back(alignUp(offsets[a] + intervals[a].bytes, interval.alignment));
+      std::sort(candidates.begin(), candidates.end());
+      candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+      for (size_t offset : candidates) {
+        if (offset < lastOffset || (offset == lastOffset && b < lastIndex)) continue;
+        if (offset + interval.bytes >= best) break;
+        bool fits = true;
+        for (size_t a = 0; a < intervals.size() && fits; ++a)
+          fits = !(placed[a] && overlaps(intervals[a], interval) && offsets[a] < offset + interval.bytes &&
+                   offset < offsets[a] + intervals[a].bytes);
+        if (!fits) continue;
+        offsets[b] = offset;
+        placed[b] = true;
+        search(remaining - 1, offset, b, std::max(top, offset + interval.bytes));
+        placed[b] = false;
+      }
+    }
+  }
+};
+}  // namespace
+
+MemoryPlan MemoryPlanner::exact(const vector<LiveInterval> &intervals, size_t numSteps,
+                                const MemoryPlan &initial) const {
+  // 大小为 0 的内存块不参与搜索
+  vector<LiveInterval> blocks;
+  vector<size_t> index;
+  for (size_t b = 0; b < intervals.size(); ++b)
+    if (intervals[b].bytes) {
+      blocks.push_back(intervals[b]);
+      index.push_back(b);
+    }
+  ExactSearch search{blocks, vector<size_t>(blocks.size(), 0), {}, vector<bool>(blocks.size(), false),
+                     initial.size, initial.lowerBound};
+  search.budget = exactBudget;
+  search.search(blocks.size(), 0, 0, 0);
+  if (search.bestOffsets.empty()) return initial;
+
+  MemoryPlan plan;
+  plan.strategy = search.nodes > exactBudget ? "exact-search (budget exhausted)" : "exact-search";
+  plan.offsets.assign(intervals.size(), 0);
+  for (size_t i = 0; i < blocks.size(); ++i) plan.offsets[index[i]] = search.bestOffsets[i];
+  plan.size = search.best;
+  plan.lowerBound = initial.lowerBound;
+  return plan;
+}
+
+MemoryPlan MemoryPlanner::plan(const vector<LiveInterval> &intervals, size_t numSteps) const {
+  MemoryPlan best = greedyBySize(intervals, numSteps);
+  MemoryPlan breadth = greedyByBreadth(intervals, numSteps);
+  if (breadth.size < best.size) best = std::move(breadth);
+  size_t blocks = std::count_if(intervals.begin(), intervals.end(), [](auto &interval) { return interval.bytes; });
+  if (best.size > best.lowerBound && blocks <= exactLimit) {
+    MemoryPlan searched = exact(intervals, numSteps, best);
+    if (searched.size < best.size) best = std::move(searched);
+  }
+  return best;
+}
+
+}  // namespace infini
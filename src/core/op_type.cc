@@ -18,6 +18,7 @@ const char *OpType::toString() const {
     CASE(Transpose);
     CASE(Concat);
     CASE(MatMul);
+    CASE(QuantizedMatMul);
 
     default:
       return "Unknown";
@@ -63,4 +63,22 @@ vector<DataType> OperatorObj::inferDataType(const TensorVec &inputs) const {
 
 vector<DataType> OperatorObj::inferDataType() const { return inferDataType(inputs); }
 
+string OperatorObj::getTuningKey() const {
+  std::ostringstream oss;
+  oss << type.toString() << "(";
+  for (size_t i = 0; i < inputs.size(); ++i)
+    oss << (i ? "," : "") << inputs[i]->getDType().toString() << vecToString(inputs[i]->getDims());
+  oss << ")->(";
+  for (size_t i = 0; i < outputs.size(); ++i)
+    oss << (i ? "," : "") << outputs[i]->getDType().toString() << vecToString(outputs[i]->getDims());
+  oss << ")";
+  return oss.str();
+}
+
+double OperatorObj::getFlops() const {
+  double flops = 0;
+  for (auto &output : outputs) flops += output->size();
+  return flops;
+}
+
 }  // namespace infini
@@ -0,0 +1,12 @@
+#include "core/plan.h"
+
+namespace infini {
+
+string PlanObj::toString() const {
+  std::ostringstream oss;
+  oss << "Plan:\n";
+  for (const auto &entry : entries) oss << entry.kernelName << ", " << entry.op << "\n";
+  return oss.str();
+}
+
+}  // namespace infini
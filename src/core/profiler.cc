@@ -0,0 +1,213 @@
+#include "core/profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+namespace infini {
+
+void Profiler::record(const Operator &op, const string &kernelName, double seconds,
+                      const PerfCounterValues *counters) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto [it, inserted] = index.try_emplace(op->getGuid(), records.size());
+  if (inserted) {
+    ProfileRecord record;
+    record.name = op->toString();
+    record.opType = op->getOpType().toString();
+    record.kernelName = kernelName;
+    record.flops = op->getFlops();
+    for (auto &input : op->getInputs()) record.bytesRead += input->getBytes();
+    for (auto &output : op->getOutputs()) record.bytesWritten += output->getBytes();
+    records.push_back(std::move(record));
+  }
+  auto &record = records[it->second];
+  record.calls++;
+  record.seconds += seconds;
+  if (counters) {
+    record.hasCounters = true;
+    record.counters += *counters;
+  }
+}
+
+size_t Profiler::endRun() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return ++runs;
+}
+
+size_t Profiler::getNumRuns() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return runs;
+}
+
+void Profiler::reset() {
+  std::lock_guard<std::mutex> lock(mutex);
+  index.clear();
+  records.clear();
+  runs = 0;
+}
+
+static void sortByTime(vector<ProfileRecord> &records) {
+  std::stable_sort(records.begin(), records.end(),
+                   [](const ProfileRecord &a, const ProfileRecord &b) { return a.seconds > b.seconds; });
+}
+
+vector<ProfileRecord> Profiler::getRecords() const {
+  vector<ProfileRecord> ret;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ret = records;
+  }
+  sortByTime(ret);
+  return ret;
+}
+
+// 把 key 相同的算子合并，运算次数和字节数按调用次数加权后再除以总的调用次数
+static vector<ProfileRecord> aggregate(const vector<ProfileRecord> &records,
+                                       const std::function<string(const ProfileRecord &)> &key) {
+  std::map<string, ProfileRecord> groups;
+  std::map<string, std::array<double, 3>> totals;
+  for (auto &record : records) {
+    auto name = key(record);
+    auto &group = groups[name];
+    if (group.calls == 0) {
+      group.name = name;
+      group.opType = record.opType;
+      group.kernelName = record.kernelName;
+    }
+    group.calls += record.calls;
+    group.seconds += record.seconds;
+    group.hasCounters = group.hasCounters || record.hasCounters;
+    group.counters += record.counters;
+    auto &total = totals[name];
+    total[0] += record.flops * record.calls;
+    total[1] += double(record.bytesRead) * record.calls;
+    total[2] += double(record.bytesWritten) * record.calls;
+  }
+  vector<ProfileRecord> ret;
+  for (auto &[name, group] : groups) {
+    auto &total = totals[name];
+    if (group.calls > 0) {
+      group.flops = total[0] / group.calls;
+      group.bytesRead = total[1] / group.calls;
+      group.bytesWritten = total[2] / group.calls;
+    }
+    ret.push_back(group);
+  }
+  sortByTime(ret);
+  return ret;
+}
+
+vector<ProfileRecord> Profiler::getRecordsByOpType() const {
+  return aggregate(getRecords(), [](const ProfileRecord &r) { return r.opType; });
+}
+
+vector<ProfileRecord> Profiler::getRecordsByKernel() const {
+  return aggregate(getRecords(), [](const ProfileRecord &r) { return r.kernelName; });
+}
+
+string Profiler::summary() const {
+  auto ops = getRecords();
+  double total = 0;
+  for (auto &record : ops) total += record.seconds;
+  const size_t numRuns = std::max<size_t>(getNumRuns(), 1);
+
+  std::ostringstream oss;
+  oss << std::fixed;
+  auto table = [&](const string &title, const vector<ProfileRecord> &records, size_t nameWidth) {
+    oss << title << "\n"
+        << std::left << std::setw(nameWidth) << "name" << std::right << std::setw(8) << "calls" << std::setw(12)
+        << "ms/run" << std::setw(8) << "%" << std::setw(12) << "us/call" << std::setw(10) << "GFLOP/s" << std::setw(10)
+        << "GB/s" << "\n";
+    for (auto &r : records) {
+      double perCall = r.calls ? r.seconds / r.calls : 0;
+      double bytes = r.bytesRead + r.bytesWritten;
+      string name = r.name.size() > nameWidth - 1 ? r.name.substr(0, nameWidth - 4) + "..." : r.name;
+      oss << std::left << std::setw(nameWidth) << name << std::right << std::setw(8) << r.calls << std::setprecision(3)
+          << std::setw(12) << r.seconds * 1e3 / numRuns << std::setprecision(1) << std::setw(8)
+          << (total > 0 ? r.seconds / total * 100 : 0) << std::setprecision(2) << std::setw(12) << perCall * 1e6
+          << std::setw(10) << (perCall > 0 ? r.flops / perCall * 1e-9 : 0) << std::setw(10)
+          << (perCall > 0 ? bytes / perCall * 1e-9 : 0) << "\n";
+    }
+    oss << "\n";
+  };
+  oss << "Profile of " << getNumRuns() << " runs, " << std::setprecision(3) << total * 1e3 / numRuns
+      << " ms per run\n\n";
+  table("By operator type:", getRecordsByOpType(), 20);
+  table("By kernel:", getRecordsByKernel(), 28);
+  table("By operator:", ops, 60);
+
+  if (std::none_of(ops.begin(), ops.end(), [](const ProfileRecord &r) { return r.hasCounters; })) return oss.str();
+  // 缺失率：最后一级缓存缺失 / 最后一级缓存访问，分支预测失败 / 分支指令
+  auto ratio = [](uint64_t a, uint64_t b) { return b ? double(a) / b : 0.; };
+  oss << "Hardware counters by operator:\n"
+      << std::left << std::setw(60) << "name" << std::right << std::setw(14) << "Mcycles/call" << std::setw(8) << "IPC"
+      << std::setw(12) << "LLC miss%" << std::setw(16) << "LLC miss/call" << std::setw(12) << "br miss%"
+      << "\n";
+  for (auto &r : ops) {
+    if (!r.hasCounters) continue;
+    auto &c = r.counters;
+    string name = r.name.size() > 59 ? r.name.substr(0, 56) + "..." : r.name;
+    oss << std::left << std::setw(60) << name << std::right << std::setprecision(3) << std::setw(14)
+        << c[PerfEvent::Cycles] * 1e-6 / r.calls << std::setprecision(2) << std::setw(8)
+        << ratio(c[PerfEvent::Instructions], c[PerfEvent::Cycles]) << std::setw(12)
+        << ratio(c[PerfEvent::CacheMisses], c[PerfEvent::CacheReferences]) * 100 << std::setprecision(0)
+        << std::setw(16) << double(c[PerfEvent::CacheMisses]) / r.calls << std::setprecision(2) << std::setw(12)
+        << ratio(c[PerfEvent::BranchMisses], c[PerfEvent::Branches]) * 100 << "\n";
+  }
+  oss << "\n";
+  return oss.str();
+}
+
+static string jsonEscape(const string &s) {
+  std::ostringstream oss;
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      oss << '\\' << c;
+    else if (static_cast<unsigned char>(c) < 0x20)
+      oss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+    else
+      oss << c;
+  }
+  return oss.str();
+}
+
+string Profiler::toJson() const {
+  std::ostringstream oss;
+  auto list = [&](const vector<ProfileRecord> &records) {
+    oss << "[";
+    for (size_t i = 0; i < records.size(); ++i) {
+      auto &r = records[i];
+      oss << (i ? ",\n    " : "\n    ") << "{\"name\": \"" << jsonEscape(r.name) << "\", \"op_type\": \"" << r.opType
+          << "\", \"kernel\": \"" << jsonEscape(r.kernelName) << "\", \"calls\": " << r.calls
+          << ", \"total_us\": " << r.seconds * 1e6 << ", \"flops\": " << r.flops << ", \"bytes_read\": " << r.bytesRead
+          << ", \"bytes_written\": " << r.bytesWritten;
+      if (r.hasCounters) {
+        auto &c = r.counters;
+        oss << ", \"cycles\": " << c[PerfEvent::Cycles] << ", \"instructions\": " << c[PerfEvent::Instructions]
+            << ", \"cache_references\": " << c[PerfEvent::CacheReferences]
+            << ", \"cache_misses\": " << c[PerfEvent::CacheMisses] << ", \"branches\": " << c[PerfEvent::Branches]
+            << ", \"branch_misses\": " << c[PerfEvent::BranchMisses];
+      }
+      oss << "}";
+    }
+    oss << "\n  ]";
+  };
+  oss << "{\n  \"runs\": " << getNumRuns() << ",\n  \"by_op_type\": ";
+  list(getRecordsByOpType());
+  oss << ",\n  \"by_kernel\": ";
+  list(getRecordsByKernel());
+  oss << ",\n  \"by_operator\": ";
+  list(getRecords());
+  oss << "\n}\n";
+  return oss.str();
+}
+
+void Profiler::writeJson(const string &path) const {
+  std::ofstream file(path);
+  IT_ASSERT(file.good(), "Cannot open profile output " + path);
+  file << toJson();
+}
+
+}  // namespace infini
@@ -1,35 +1,359 @@
 #include "core/runtime.h"
 
+#include <algorithm>
 #include <chrono>
+#include <condition_variable>
+#include <cstdlib>
 #include <cstring>
+#include <exception>
+#include <iostream>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
+#include <unistd.h>
+
+#include "core/async_runner.h"
 #include "core/blob.h"
+#include "core/context.h"
 #include "core/graph.h"
 #include "core/kernel.h"
+#include "core/plan.h"
+#include "core/profiler.h"
+#include "core/tracer.h"
+#include "core/tuner.h"
 namespace infini {
+NativeCpuRuntimeObj::NativeCpuRuntimeObj()
+    : RuntimeObj(Device::CPU),
+      threadPool(std::make_unique<ThreadPool>()),
+      asyncRunner(std::make_unique<AsyncRunner>(this)),
+      profiler(std::make_unique<Profiler>()),
+      tracer(std::make_unique<Tracer>()) {
+  if (const char *runs = std::getenv("INFINI_PROFILE")) {
+    profileReportRuns = std::strtoul(runs, nullptr, 10);
+    profiling = profileReportRuns > 0;
+  }
+  if (const char *output = std::getenv("INFINI_PROFILE_OUTPUT")) profileOutput = output;
+  if (const char *counters = std::getenv("INFINI_PERF_COUNTERS")) hardwareCounters = std::atoi(counters) != 0;
+  if (const char *cache = std::getenv("INFINI_TUNING_CACHE"))
+    setTuning(true, cache);
+  else if (const char *tune = std::getenv("INFINI_TUNE"))
+    setTuning(std::atoi(tune) != 0);
+  if (const char *output = std::getenv("INFINI_TRACE")) {
+    traceOutput = output;
+    tracing = !traceOutput.empty();
+  }
+  if (const char *mode = std::getenv("INFINI_HUGE_PAGES")) {
+    const string value = mode;
+    mmapConfig.enable = true;
+    if (value == "none" || value == "0")
+      mmapConfig.hugePages = HugePageMode::None;
+    else if (value == "explicit")
+      mmapConfig.hugePages = HugePageMode::Explicit;
+    else
+      mmapConfig.hugePages = HugePageMode::Transparent;
+  }
+  if (const char *node = std::getenv("INFINI_NUMA_NODE")) {
+    mmapConfig.enable = true;
+    mmapConfig.numaNode = std::atoi(node);
+  }
+}
+
+NativeCpuRuntimeObj::~NativeCpuRuntimeObj() {
+  if (traceOutput.empty()) return;
+  // 析构函数不能抛出异常，写入失败时只打印错误
+  try {
+    tracer->writeJson(traceOutput);
+  } catch (const std::exception &e) {
+    std::cerr << "Failed to write trace to " << traceOutput << ": " << e.what() << std::endl;
+  }
+}
+
+void NativeCpuRuntimeObj::setTuning(bool enable, const string &cachePath) {
+  tuner = enable ? std::make_unique<KernelTuner>(cachePath) : nullptr;
+}
+
+void NativeCpuRuntimeObj::tune(const Graph &graph) const {
+  if (tuner) tuner->tune(graph, this);
+}
+
+void NativeCpuRuntimeObj::setAsyncConfig(const AsyncConfig &config) { asyncRunner->configure(config); }
+
+const AsyncConfig &NativeCpuRuntimeObj::getAsyncConfig() const { return asyncRunner->getConfig(); }
+
+std::future<void> NativeCpuRuntimeObj::runAsync(const Plan &plan) const { return asyncRunner->submit(plan); }
+
+void NativeCpuRuntimeObj::runAsync(const Plan &plan, std::function<void(std::exception_ptr)> done) const {
+  asyncRunner->submit(plan, std::move(done));
+}
+
+std::future<void> NativeCpuRuntimeObj::runAsync(const ExecutionContext &context) const {
+  return asyncRunner->submit(context);
+}
+
+void NativeCpuRuntimeObj::runAsync(const ExecutionContext &context,
+                                   std::function<void(std::exception_ptr)> done) const {
+  asyncRunner->submit(context, std::move(done));
+}
+
 void NativeCpuRuntimeObj::run(const Graph &graph) const {
+  if (scheduleMode == ScheduleMode::Parallel) return run(compile(graph));
+
   // 获取搜索 kernel 的单例
   const auto &kernelRegistry = KernelRegistry::getInstance();
 
   // 依次遍历每个算子，搜索对应的 kernel 执行算子对应的运算
-  for (auto &op : graph->getOperators()) {
-    // 根据算子的类型和设备类型，设置所需要的 kernel 属性
-    auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying()};
-    // 获取对应的 kernel
-    Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
+  const auto &ops = graph->getOperators();
+  const bool instrumented = profiling || tracing;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    auto &op = ops[i];
+    // 被 dataMalloc 消除的算子的输出已经由其他算子写好
+    if (graph->isElided(op)) continue;
+    // 根据算子的类型和设备类型获取对应的 kernel（自动调优选定的或默认的实现）
+    const auto &kernelItem = kernelRegistry.getKernelItem(device, op);
+    Kernel *kernel = std::get<0>(kernelItem);
     // 利用 kernel 进行计算
-    kernel->compute(op, this);
+    if (!instrumented) {
+      kernel->compute(op, this);
+      continue;
+    }
+    instrument(graph, i, op, std::get<1>(kernelItem), [&] { kernel->compute(op, this); });
   }
+  if (profiling) endProfiledRun();
+}
+
+void NativeCpuRuntimeObj::instrument(const Graph &graph, size_t index, const Operator &op, const string &kernelName,
+                                     const std::function<void()> &compute) const {
+  // 计数器只统计打开它的线程，每个线程各自打开一次；kernel 在线程池其他线程上执行的部分由 scope 汇总
+  bool counting = false;
+  if (profiling && hardwareCounters) {
+    static std::once_flag warned;
+    counting = PerfCounters::forCurrentThread().isAvailable();
+    if (!counting)
+      std::call_once(warned, [] { std::cerr << "Hardware performance counters are unavailable, recording time only\n"; });
+  }
+  PerfCounterScope scope;
+  if (counting) scope.start();
+  auto start = std::chrono::steady_clock::now();
+  try {
+    compute();
+  } catch (...) {
+    if (counting) scope.stop();
+    throw;
+  }
+  auto end = std::chrono::steady_clock::now();
+  PerfCounterValues counters;
+  if (counting) counters = scope.stop();
+  if (profiling)
+    profiler->record(op, kernelName, std::chrono::duration<double>(end - start).count(), counting ? &counters : nullptr);
+  if (tracing) {
+    const auto &liveBytes = graph->getLiveBytes();
+    tracer->record(op, kernelName, graph->getDataArena(), start, end, index < liveBytes.size() ? liveBytes[index] : 0);
+  }
+}
+
+void NativeCpuRuntimeObj::endProfiledRun() const {
+  if (profiler->endRun() != profileReportRuns) return;
+  std::cout << profiler->summary();
+  if (!profileOutput.empty()) profiler->writeJson(profileOutput);
+}
+
+void NativeCpuRuntimeObj::run(const Plan &plan) const {
+  // 同一个计划的数据指针是固定的，多个线程同时执行同一个计划时依次进行
+  std::lock_guard<std::mutex> running(plan->getRunMutex());
+  const auto &entries = plan->getEntries();
+  execute(plan, [&](size_t i) { entries[i].launch(entries[i].inputs.data(), entries[i].outputs.data()); });
+}
+
+void NativeCpuRuntimeObj::run(const ExecutionContext &context) const {
+  // 不同的上下文使用各自的内存，只有同一个上下文的执行需要依次进行
+  std::lock_guard<std::mutex> running(context->getRunMutex());
+  execute(context->getPlan(), [&](size_t i) { context->launch(i); });
+}
+
+void NativeCpuRuntimeObj::execute(const Plan &plan, const std::function<void(size_t)> &run) const {
+  const auto &entries = plan->getEntries();
+  if (!profiling && !tracing) return schedule(plan, run);
+  // 包装每一项的执行，记录耗时后按原来的调度方式执行
+  schedule(plan, [&](size_t i) {
+    instrument(plan->getGraph(), entries[i].step, entries[i].op, entries[i].kernelName, [&] { run(i); });
+  });
+  if (profiling) endProfiledRun();
+}
+
+void NativeCpuRuntimeObj::schedule(const Plan &plan, const std::function<void(size_t)> &launch) const {
+  const auto &entries = plan->getEntries();
+  if (scheduleMode == ScheduleMode::Sequential || entries.size() <= 1) {
+    for (size_t i = 0; i < entries.size(); ++i) launch(i);
+    return;
+  }
+  IT_ASSERT(plan->getGraph()->isConcurrentMalloc(),
+            "Parallel schedule requires a graph allocated with dataMalloc(true)");
+
+  // 每一项剩余未完成的前驱个数，减到 0 时提交该项；最后一项完成时唤醒调用线程
+  vector<std::atomic<size_t>> waiting(entries.size());
+  for (size_t i = 0; i < entries.size(); ++i) waiting[i] = entries[i].numPredecessors;
+  std::atomic<size_t> remaining(entries.size());
+  std::mutex mutex;
+  std::condition_variable finished;
+  bool done = false;
+  std::exception_ptr error;
+  std::atomic<bool> failed(false);
+
+  std::function<void(size_t)> submit = [&](size_t i) {
+    threadPool->submit([&, i] {
+      const auto &entry = entries[i];
+      // 与依次执行一致，出错之后不再执行其他项（它们的输入可能没有写好），但仍然更新计数使等待能够结束
+      if (!failed.load(std::memory_order_acquire)) {
+        try {
+          launch(i);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!error) error = std::current_exception();
+          failed.store(true, std::memory_order_release);
+        }
+      }
+      // 后继按逆序提交，使第一个后继最后入队、最先被当前线程取出执行
+      for (auto it = entry.successors.rbegin(); it != entry.successors.rend(); ++it)
+        if (waiting[*it].fetch_sub(1) == 1) submit(*it);
+      if (remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        finished.notify_all();
+      }
+    });
+  };
+  for (size_t i = 0; i < entries.size(); ++i)
+    if (entries[i].numPredecessors == 0) submit(i);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [&] { return done; });
+  if (error) std::rethrow_exception(error);
+}
+
+Plan RuntimeObj::compile(const Graph &graph) const {
+  IT_ASSERT(graph->topo_sort() == true);
+  tune(graph);
+  const auto &kernelRegistry = KernelRegistry::getInstance();
+  const auto &ops = graph->getOperators();
+  // 被消除的算子不进入计划
+  std::unordered_map<OperatorObj *, size_t> index;
+  for (auto &op : ops)
+    if (!graph->isElided(op)) index.emplace(op.get(), index.size());
+
+  vector<PlanObj::Entry> entries;
+  for (size_t step = 0; step < ops.size(); ++step) {
+    auto &op = ops[step];
+    if (graph->isElided(op)) continue;
+    PlanObj::Entry entry;
+    entry.op = op;
+    entry.step = step;
+    const auto &kernelItem = kernelRegistry.getKernelItem(device, op);
+    entry.kernel = std::get<0>(kernelItem);
+    entry.kernelName = std::get<1>(kernelItem);
+    entry.launch = entry.kernel->prepare(op, this);
+    for (const auto &input : op->getInputs()) entry.inputs.push_back(input->getRawDataPtr<void *>());
+    for (const auto &output : op->getOutputs()) entry.outputs.push_back(output->getRawDataPtr<void *>());
+    // 一个算子可能多次使用另一个算子的输出，依赖关系去重；被消除的后继换成它的后继
+    std::unordered_set<size_t> successors;
+    std::function<void(const Operator &)> addSuccessors = [&](const Operator &from) {
+      for (const auto &succ : from->getSuccessors()) {
+        if (graph->isElided(succ))
+          addSuccessors(succ);
+        else if (successors.insert(index.at(succ.get())).second)
+          entry.successors.push_back(index.at(succ.get()));
+      }
+    };
+    addSuccessors(op);
+    entries.push_back(std::move(entry));
+  }
+  for (const auto &entry : entries)
+    for (size_t succ : entry.successors) ++entries[succ].numPredecessors;
+  return make_ref<PlanObj>(graph, std::move(entries));
+}
+
+void RuntimeObj::setAlignment(size_t alignment, size_t pageAlignThreshold) {
+  IT_ASSERT(alignment >= sizeof(uint64_t) && (alignment & (alignment - 1)) == 0,
+            "Alignment must be a power of two no less than 8");
+  this->alignment = alignment;
+  this->pageAlignThreshold = pageAlignThreshold;
+}
+
+size_t RuntimeObj::getAlignment(size_t bytes) const {
+  if (pageAlignThreshold && bytes >= pageAlignThreshold) return std::max(alignment, getPageSize());
+  return alignment;
+}
+
+size_t RuntimeObj::getBaseAlignment() const {
+  return pageAlignThreshold ? std::max(alignment, getPageSize()) : alignment;
+}
+
+size_t RuntimeObj::getPageSize() {
+  static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return pageSize;
 }
 
 string NativeCpuRuntimeObj::toString() const { return "CPU Runtime"; }
 
-void NativeCpuRuntimeObj::dealloc(void *ptr) { return free(ptr); }
+void NativeCpuRuntimeObj::dealloc(void *ptr) {
+  {
+    std::lock_guard<std::mutex> lock(mmapMutex);
+    auto it = mmapRegions.find(ptr);
+    if (it != mmapRegions.end()) {
+      munmapArena(it->second);
+      mmapRegions.erase(it);
+      return;
+    }
+  }
+  free(ptr);
+}
+
+const MmapRegion *NativeCpuRuntimeObj::getMmapRegion(void *ptr) {
+  std::lock_guard<std::mutex> lock(mmapMutex);
+  auto it = mmapRegions.find(ptr);
+  return it != mmapRegions.end() ? &it->second : nullptr;
+}
+
+/**
+ * @brief 线程池的每个线程写入连续的一段页面，使页面分配在之后按同样方式分块计算的线程所在的 NUMA 节点上
+ */
+static void firstTouch(ThreadPool *pool, const MmapRegion &region) {
+  const size_t page = RuntimeObj::getPageSize(), pages = region.length / page;
+  const size_t tasks = std::min<size_t>(getNumThreads(pool), pages);
+  auto base = static_cast<volatile char *>(region.ptr);
+  parallelFor(pool, tasks, [&](size_t task) {
+    for (size_t i = pages * task / tasks; i < pages * (task + 1) / tasks; ++i) base[i * page] = 0;
+  });
+}
 
 void *NativeCpuRuntimeObj::alloc(size_t size) {
-  // size + sizeof(uint64_t) - 1 使得分配的空间大于等于 size 且是 uint64_t 的整数倍
-  return calloc((size + sizeof(uint64_t) - 1) / sizeof(uint64_t), sizeof(uint64_t));
+  if (mmapConfig.enable && size >= mmapConfig.minSize) {
+    // mmap 得到的匿名内存已经是 0，不需要清零
+    MmapRegion region = mmapArena(size, getBaseAlignment(), mmapConfig);
+    if (region.ptr) {
+      static std::once_flag warnHugePages, warnNuma;
+      if (mmapConfig.hugePages != HugePageMode::None && !region.hugePages)
+        std::call_once(warnHugePages, [] { std::cerr << "Huge pages are unavailable, using normal pages\n"; });
+      if (mmapConfig.numaNode >= 0 && !region.numaBound)
+        std::call_once(warnNuma, [&] {
+          std::cerr << "Failed to bind memory to NUMA node " << mmapConfig.numaNode << ", using the default policy\n";
+        });
+      if (mmapConfig.parallelFirstTouch) firstTouch(threadPool.get(), region);
+      std::lock_guard<std::mutex> lock(mmapMutex);
+      mmapRegions.emplace(region.ptr, region);
+      return region.ptr;
+    }
+    static std::once_flag warnMmap;
+    std::call_once(warnMmap, [] { std::cerr << "mmap failed, falling back to aligned_alloc\n"; });
+  }
+  // aligned_alloc 要求大小是对齐字节数的整数倍，大小为 0 时也分配一个对齐单位，保证返回的指针非空
+  const size_t align = getBaseAlignment();
+  size = std::max<size_t>((size + align - 1) / align, 1) * align;
+  void *ptr = std::aligned_alloc(align, size);
+  IT_ASSERT(ptr != nullptr, "Failed to allocate " + std::to_string(size) + " bytes");
+  std::memset(ptr, 0, size);
+  return ptr;
 }
 
 }  // namespace infini
@@ -0,0 +1,104 @@
+#include "core/tracer.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace infini {
+
+// 转义 JSON 字符串中的引号、反斜杠和控制字符，kernel 名称等字符串可能包含这些字符
+static string escapeJson(const string &str) {
+  string out;
+  out.reserve(str.size());
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else if (c == '\t') {
+      out += "\\t";
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned char>(c));
+      out += buf;
+    } else {
+      out += c;
+    }
+  }
+  return out;
+}
+
+// 张量的描述：形状、数据类型以及在计算图内存中的偏移量（不在其中时为 -1）
+static string describeTensors(const TensorVec &tensors, pair<uint8_t *, size_t> arena) {
+  std::ostringstream oss;
+  oss << "[";
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto ptr = tensors[i]->getRawDataPtr<uint8_t *>();
+    long offset = ptr >= arena.first && ptr < arena.first + arena.second ? long(ptr - arena.first) : -1;
+    oss << (i ? ", " : "") << "{\"guid\": " << tensors[i]->getGuid() << ", \"shape\": \""
+        << vecToString(tensors[i]->getDims()) << "\", \"dtype\": \"" << escapeJson(tensors[i]->getDType().toString())
+        << "\", \"offset\": " << offset << "}";
+  }
+  oss << "]";
+  return oss.str();
+}
+
+void Tracer::record(const Operator &op, const string &kernelName, pair<uint8_t *, size_t> arena,
+                    Clock::time_point start, Clock::time_point end, size_t liveBytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto guid = op->getGuid();
+  if (!ops.count(guid)) {
+    std::ostringstream args;
+    args << "{\"guid\": " << guid << ", \"kernel\": \"" << escapeJson(kernelName)
+         << "\", \"inputs\": " << describeTensors(op->getInputs(), arena)
+         << ", \"outputs\": " << describeTensors(op->getOutputs(), arena) << "}";
+    ops[guid] = {escapeJson(op->getOpType().toString()), args.str()};
+  }
+  auto thread = threads.try_emplace(std::this_thread::get_id(), threads.size()).first->second;
+  slices.push_back({guid, start, end, thread, liveBytes});
+}
+
+void Tracer::reset() {
+  std::lock_guard<std::mutex> lock(mutex);
+  origin = Clock::now();
+  slices.clear();
+  ops.clear();
+  threads.clear();
+}
+
+size_t Tracer::getNumSlices() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  return slices.size();
+}
+
+string Tracer::toJson() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto us = [&](Clock::time_point t) { return std::chrono::duration<double, std::micro>(t - origin).count(); };
+  std::ostringstream oss;
+  oss << std::fixed;
+  oss.precision(3);
+  oss << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  oss << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"InfiniTensor CPU\"}}";
+  for (auto &[id, thread] : threads)
+    oss << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread
+        << ", \"args\": {\"name\": \"thread " << thread << "\"}}";
+  for (auto &slice : slices) {
+    auto &[name, args] = ops.at(slice.op);
+    oss << ",\n  {\"name\": \"" << name << "\", \"cat\": \"op\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << slice.thread
+        << ", \"ts\": " << us(slice.start) << ", \"dur\": " << us(slice.end) - us(slice.start)
+        << ", \"args\": " << args << "}";
+    oss << ",\n  {\"name\": \"live bytes\", \"ph\": \"C\", \"pid\": 1, \"ts\": " << us(slice.start)
+        << ", \"args\": {\"bytes\": " << slice.liveBytes << "}}";
+  }
+  oss << "\n]}\n";
+  return oss.str();
+}
+
+void Tracer::writeJson(const string &path) const {
+  std::ofstream file(path);
+  IT_ASSERT(file.good(), "Cannot open trace output " + path);
+  file << toJson();
+  IT_ASSERT(file.good(), "Failed to write trace output " + path);
+}
+
+}  // namespace infini
@@ -0,0 +1,150 @@
+#include "core/tuner.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "core/blob.h"
+#include "core/kernel.h"
+#include "utils/cpu_info.h"
+
+namespace infini {
+
+void KernelTuner::load() {
+  loaded = true;
+  if (cachePath.empty()) return;
+  // 每行为 “CPU 标识<TAB>调优键<TAB>kernel 名称”，调优键中不含制表符。
+  // 只使用当前 CPU 的选择，其他机器的记录原样保留，保存时一起写回
+  std::ifstream file(cachePath);
+  const string &cpu = getCpuSignature();
+  for (string line; std::getline(file, line);) {
+    auto first = line.find('\t'), last = line.rfind('\t');
+    if (first == last) continue;  // 没有 CPU 标识的旧格式，重新测量
+    if (line.compare(0, first, cpu) == 0 && first == cpu.size())
+      choices[line.substr(first + 1, last - first - 1)] = line.substr(last + 1);
+    else
+      otherCpus.push_back(line);
+  }
+}
+
+void KernelTuner::save() const {
+  if (cachePath.empty()) return;
+  std::ofstream file(cachePath);
+  IT_ASSERT(file.good(), "Cannot open tuning cache " + cachePath);
+  for (auto &line : otherCpus) file << line << '\n';
+  for (auto &[key, name] : choices) file << getCpuSignature() << '\t' << key << '\t' << name << '\n';
+}
+
+std::map<string, string> KernelTuner::getChoices() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!loaded) load();
+  return choices;
+}
+
+// 在调优器自己申请的内存中执行 kernel 若干次，返回最短的一次耗时。计算图的内存中可能已经写好了输入，
+// 而规划时复用了内存的输出可能与它们重叠，因此不能直接在张量的数据指针上测量
+static double benchmark(const Kernel *kernel, const Operator &op, const Runtime &graphRuntime,
+                        const RuntimeObj *runtime, int repeats) {
+  vector<void *> inputs, outputs;
+  for (auto &input : op->getInputs()) {
+    // 输入复制当前的数据，使测量时的数据与实际执行时相近
+    inputs.push_back(graphRuntime->alloc(input->getBytes()));
+    std::memcpy(inputs.back(), input->getRawDataPtr<void *>(), input->getBytes());
+  }
+  for (auto &output : op->getOutputs()) outputs.push_back(graphRuntime->alloc(output->getBytes()));
+  auto release = [&] {
+    for (void *ptr : inputs) graphRuntime->dealloc(ptr);
+    for (void *ptr : outputs) graphRuntime->dealloc(ptr);
+  };
+  double best = std::numeric_limits<double>::max();
+  try {
+    auto launch = kernel->prepare(op, runtime);
+    launch(inputs.data(), outputs.data());  // 预热
+    for (int r = 0; r < repeats; ++r) {
+      auto start = std::chrono::steady_clock::now();
+      launch(inputs.data(), outputs.data());
+      best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+  } catch (...) {
+    release();
+    throw;
+  }
+  release();
+  return best;
+}
+
+void KernelTuner::tune(const Graph &graph, const RuntimeObj *runtime) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!loaded) load();
+  const auto &registry = KernelRegistry::getInstance();
+  auto graphRuntime = graph->getRuntime();
+  bool updated = false;
+
+  for (auto &op : graph->getOperators()) {
+    if (graph->isElided(op)) continue;
+    const KernelAttrs attrs = KernelRegistry::getKernelAttrs(runtime->getDevice(), op);
+    const auto &candidates = registry.getKernelCandidates(attrs);
+    if (candidates.size() <= 1) continue;
+    const auto &currentItem = registry.getKernelItem(runtime->getDevice(), op);
+    const Kernel *current = std::get<0>(currentItem);
+    const Blob prepacked = op->getPrepackedData();  // 测量时会临时替换，需要保存一份
+    const size_t prepackSize = prepacked ? current->getPrepackSize(op, runtime) : 0;
+    // 已经预打包的算子只能换成打包大小相同的候选，选中后直接重新打包到原来的缓冲中
+    auto fitsPrepacked = [&](const Kernel *kernel) {
+      return !prepacked || kernel->getPrepackSize(op, runtime) == prepackSize;
+    };
+
+    auto key = op->getTuningKey();
+    auto cached = choices.find(key);
+    string choice;
+    auto isCandidate = [&](const string &name) {
+      return std::any_of(candidates.begin(), candidates.end(), [&](auto &c) { return std::get<1>(c) == name; });
+    };
+    if (cached != choices.end() && isCandidate(cached->second)) {
+      // 缓存的选择可能来自没有预打包的计算图，打包大小不同时保留当前的 kernel
+      const Kernel *cachedKernel = std::get<0>(registry.getKernelItem(attrs, cached->second));
+      choice = fitsPrepacked(cachedKernel) ? cached->second : std::get<1>(currentItem);
+    } else {
+      double best = std::numeric_limits<double>::max();
+      for (auto &[kernel, name, id] : candidates) {
+        if (!fitsPrepacked(kernel)) continue;
+        Blob scratch;
+        if (prepacked) scratch = make_ref<BlobObj>(graphRuntime, graphRuntime->alloc(prepackSize));
+        // 测量结束或失败时都要恢复原来的打包数据并释放临时缓冲
+        auto restore = [&] {
+          if (!scratch) return;
+          op->setPrepackedData(prepacked);
+          graphRuntime->dealloc(scratch->getPtr<void *>());
+        };
+        double seconds;
+        try {
+          if (scratch) {
+            kernel->prepack(op, runtime, scratch->getPtr<void *>());
+            op->setPrepackedData(scratch);
+          }
+          seconds = benchmark(kernel, op, graphRuntime, runtime, repeats);
+        } catch (...) {
+          restore();
+          throw;
+        }
+        restore();
+        if (seconds < best) {
+          best = seconds;
+          choice = name;
+        }
+      }
+      choices[key] = choice;
+      updated = true;
+    }
+
+    // 默认实现不需要记录名称
+    const auto &selected = registry.getKernelItem(attrs, choice);
+    op->setKernelName(&selected == &candidates.front() ? "" : choice);
+    if (prepacked && std::get<0>(selected) != current)
+      std::get<0>(selected)->prepack(op, runtime, prepacked->getPtr<void *>());
+  }
+  if (updated) save();
+}
+
+}  // namespace infini
@@ -0,0 +1,192 @@
+#include "core/kernel.h"
+#include "kernels/cpu/element_wise.h"
+#include "operators/unary.h"
+#include "utils/cpu_info.h"
+#include "utils/float16.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace infini {
+
+// 整数之间按 C++ 的 static_cast 语义转换（截断高位）；浮点数转换为整数时向零取整并饱和到目标类型的范围，
+// NaN 转换为 0。直接 static_cast 超出范围的浮点数是未定义行为
+template <typename TOut>
+struct CastOp {
+    template <typename TIn>
+    TOut operator()(TIn val) const {
+        if constexpr (std::is_floating_point_v<TIn> && std::is_integral_v<TOut>) {
+            // 目标类型的上界转换为浮点数后可能向上舍入（例如 2^31），因此用 >= 比较
+            constexpr TIn lo = static_cast<TIn>(std::numeric_limits<TOut>::min());
+            constexpr TIn hi = static_cast<TIn>(std::numeric_limits<TOut>::max());
+            if (val != val)
+                return 0;
+            if (val <= lo)
+                return std::numeric_limits<TOut>::min();
+            if (val >= hi)
+                return std::numeric_limits<TOut>::max();
+        }
+        return static_cast<TOut>(val);
+    }
+};
+
+struct Fp16ToFp32Op {
+    float operator()(uint16_t val) const { return fp16ToFp32(val); }
+};
+
+struct Fp32ToFp16Op {
+    uint16_t operator()(float val) const { return fp32ToFp16(val); }
+};
+
+struct Bf16ToFp32Op {
+    float operator()(uint16_t val) const { return bf16ToFp32(val); }
+};
+
+struct Fp32ToBf16Op {
+    uint16_t operator()(float val) const { return fp32ToBf16(val); }
+};
+
+#if defined(__x86_64__)
+// F16C 每次转换 8 个元素，尾部使用与指令逐位一致的软件实现
+__attribute__((target("avx,f16c"))) static void fp32ToFp16F16c(const float *in, uint16_t *out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+    for (; i < n; ++i)
+        out[i] = fp32ToFp16(in[i]);
+}
+
+__attribute__((target("avx,f16c"))) static void fp16ToFp32F16c(const uint16_t *in, float *out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i))));
+    for (; i < n; ++i)
+        out[i] = fp16ToFp32(in[i]);
+}
+
+// AVX512_BF16 每次转换 16 个元素
+__attribute__((target("avx512f,avx512bf16"))) static void fp32ToBf16Avx512(const float *in, uint16_t *out,
+                                                                           size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256bh v = _mm512_cvtneps_pbh(_mm512_loadu_ps(in + i));
+        std::memcpy(out + i, &v, sizeof(v));
+    }
+    for (; i < n; ++i)
+        out[i] = fp32ToBf16(in[i]);
+}
+#endif
+
+class NativeCast : public CpuKernelWithoutConfig {
+    template <typename TIn, typename TOut>
+    static PreparedKernel cast(const Ref<CastObj> &op, ThreadPool *pool) {
+        const size_t n = op->getOutput()->size();
+        return [n, pool](void *const *inputs, void *const *outputs) {
+            elementWiseUnary(pool, CastOp<TOut>(), static_cast<const TIn *>(inputs[0]),
+                             static_cast<TOut *>(outputs[0]), n);
+        };
+    }
+
+    // CPU 支持对应的转换指令时使用 convert，否则使用逐位一致的软件实现 Op
+    template <typename TIn, typename TOut, typename Op>
+    static PreparedKernel castHalf(const Ref<CastObj> &op, ThreadPool *pool,
+                                   void (*convert)(const TIn *, TOut *, size_t)) {
+        const size_t n = op->getOutput()->size();
+        return [n, pool, convert](void *const *inputs, void *const *outputs) {
+            const TIn *in = static_cast<const TIn *>(inputs[0]);
+            TOut *out = static_cast<TOut *>(outputs[0]);
+            if (convert)
+                elementWiseParallel(pool, n, [&](size_t begin, size_t end) { convert(in + begin, out + begin, end - begin); });
+            else
+                elementWiseUnary(pool, Op(), in, out, n);
+        };
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        computePrepared(_op, context);
+    }
+
+    PreparedKernel prepare(const Operator &_op,
+                           const RuntimeObj *context) const override {
+        auto op = as<CastObj>(_op);
+        ThreadPool *pool = context->getThreadPool();
+        void (*fp32ToFp16Hw)(const float *, uint16_t *, size_t) = nullptr;
+        void (*fp16ToFp32Hw)(const uint16_t *, float *, size_t) = nullptr;
+        void (*fp32ToBf16Hw)(const float *, uint16_t *, size_t) = nullptr;
+#if defined(__x86_64__)
+        if (getCpuFeatures().f16c) {
+            fp32ToFp16Hw = fp32ToFp16F16c;
+            fp16ToFp32Hw = fp16ToFp32F16c;
+        }
+        if (getCpuFeatures().avx512bf16)
+            fp32ToBf16Hw = fp32ToBf16Avx512;
+#endif
+
+        switch (op->getType()) {
+        case CastType::Float2Float16:
+            return castHalf<float, uint16_t, Fp32ToFp16Op>(op, pool, fp32ToFp16Hw);
+        case CastType::Float2Int64:
+            return cast<float, int64_t>(op, pool);
+        case CastType::Float2Int32:
+            return cast<float, int32_t>(op, pool);
+        case CastType::Float2Int16:
+            return cast<float, int16_t>(op, pool);
+        case CastType::Float2Int8:
+            return cast<float, int8_t>(op, pool);
+        case CastType::Float2BFloat16:
+            return castHalf<float, uint16_t, Fp32ToBf16Op>(op, pool, fp32ToBf16Hw);
+        case CastType::Int322Float:
+            return cast<int32_t, float>(op, pool);
+        case CastType::Int322Int8:
+            return cast<int32_t, int8_t>(op, pool);
+        case CastType::Int322Int16:
+            return cast<int32_t, int16_t>(op, pool);
+        case CastType::Int322Int64:
+            return cast<int32_t, int64_t>(op, pool);
+        case CastType::Int162Float:
+            return cast<int16_t, float>(op, pool);
+        case CastType::Int162Int32:
+            return cast<int16_t, int32_t>(op, pool);
+        case CastType::Int82Float:
+            return cast<int8_t, float>(op, pool);
+        case CastType::Int82Int16:
+            return cast<int8_t, int16_t>(op, pool);
+        case CastType::Int82Int32:
+            return cast<int8_t, int32_t>(op, pool);
+        case CastType::Uint82Float:
+            return cast<uint8_t, float>(op, pool);
+        case CastType::Uint82Int32:
+            return cast<uint8_t, int32_t>(op, pool);
+        case CastType::Uint82Int64:
+            return cast<uint8_t, int64_t>(op, pool);
+        case CastType::Int642Int32:
+            return cast<int64_t, int32_t>(op, pool);
+        case CastType::Int642Uint32:
+            return cast<int64_t, uint32_t>(op, pool);
+        case CastType::Int642Float:
+            return cast<int64_t, float>(op, pool);
+        case CastType::Uint322Int64:
+            return cast<uint32_t, int64_t>(op, pool);
+        case CastType::Float162Float:
+            return castHalf<uint16_t, float, Fp16ToFp32Op>(op, pool, fp16ToFp32Hw);
+        case CastType::BFloat162Float:
+            // bfloat16 到 float32 只需要左移 16 位，编译器可以直接向量化
+            return castHalf<uint16_t, float, Bf16ToFp32Op>(op, pool, nullptr);
+        case CastType::Float2Float:
+            return cast<float, float>(op, pool);
+        default:
+            IT_TODO_HALT();
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Cast, NativeCast, "Cast_CPU");
+
+} // namespace infini
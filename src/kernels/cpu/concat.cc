@@ -1,64 +1,132 @@
+#include "kernels/cpu/concat.h"
 #include "operators/concat.h"
 #include "core/kernel.h"
+#include "utils/cpu_info.h"
+#include "utils/thread_pool.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 
 namespace infini {
 
-class NaiveConcat : public CpuKernelWithoutConfig {
-    template <typename T>
-    void doCompute(const Operator &_op, const RuntimeObj *context) const {
-        auto op = as<ConcatObj>(_op);
-        auto inputs = op->getInputs(), outputs = op->getOutputs();
-        auto dim = op->getDim();
-        auto output = outputs[0];
-        std::vector<Shape> iDims;
-        for (auto input : inputs)
-            iDims.emplace_back(input->getDims());
-        const auto &outDim = output->getDims();
-        size_t blockOffsetInner = 1;
-        for (size_t i = outDim.size() - 1; i > (size_t)dim; --i)
-            blockOffsetInner *= outDim[i];
-        size_t blockOffset = outDim[dim] * blockOffsetInner;
-        for (size_t i = 0; i < inputs.size(); ++i) {
-            auto input = inputs[i];
-            auto dimOffset = 0;
-            auto iDim = iDims[i];
-            for (size_t j = 0; j < i; ++j)
-                dimOffset += iDims[j][dim];
-            size_t localBlockOffset = 1;
-            for (size_t i = iDim.size() - 1;
-                 i >= (size_t)dim && i != (size_t)-1; --i)
-                localBlockOffset *= iDim[i];
-            auto innerOffset = blockOffsetInner * dimOffset;
-            auto inSize = input->size();
-            auto inPtr = input->getRawDataPtr<T *>(),
-                 outPtr = output->getRawDataPtr<T *>();
-#pragma omp parallel for
-            for (size_t iOffset = 0; iOffset < inSize; ++iOffset) {
-                auto oOffset = iOffset % localBlockOffset + innerOffset +
-                               iOffset / localBlockOffset * blockOffset;
-                outPtr[oOffset] = inPtr[iOffset];
-            }
-        }
+// 单个拷贝任务的最大字节数，较大的块会被切分，使 outer 很小时也能并行
+constexpr size_t kConcatChunkBytes = 256 << 10;
+// 总字节数不低于该值时才启用多线程
+constexpr size_t kConcatParallelBytes = 64 << 10;
+// 流式写入只对足够长的一段使用，较短的段首尾的非对齐部分占比太高
+constexpr size_t kConcatStreamBytes = 256;
+
+// 为 0 时使用最后一级缓存的大小
+static std::atomic<size_t> concatStreamThreshold{0};
+
+size_t getConcatStreamThreshold() {
+    size_t threshold = concatStreamThreshold.load(std::memory_order_relaxed);
+    return threshold ? threshold : getLastLevelCacheSize();
+}
+
+void setConcatStreamThreshold(size_t bytes) { concatStreamThreshold.store(bytes, std::memory_order_relaxed); }
+
+/**
+ * @brief 使用非临时（streaming）写入拷贝一段内存，绕过缓存直接写回内存，
+ * 避免大于最后一级缓存的输出把其他数据挤出缓存。调用者需要在所有写入完成后执行 sfence
+ */
+static void streamCopy(uint8_t *dst, const uint8_t *src, size_t bytes) {
+#if defined(__x86_64__)
+    size_t head = std::min(bytes, (16 - (uintptr_t)dst % 16) % 16);
+    std::memcpy(dst, src, head);
+    dst += head, src += head, bytes -= head;
+    for (; bytes >= 64; bytes -= 64, dst += 64, src += 64) {
+        __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+        __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+        __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst), v0);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst + 16), v1);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst + 32), v2);
+        _mm_stream_si128(reinterpret_cast<__m128i *>(dst + 48), v3);
     }
+#endif
+    std::memcpy(dst, src, bytes);
+}
+
+class NativeConcat : public CpuKernelWithoutConfig {
+    // 每个输入在输出的一行（dim 及之后的维度）中占据连续的一段，一段可能被切分成多个拷贝任务
+    struct Piece {
+        size_t input;       // 输入的下标
+        size_t srcRowBytes; // 输入一行的字节数
+        size_t srcOffset;   // 在输入的一行中的字节偏移
+        size_t dstOffset;   // 在输出的一行中的字节偏移
+        size_t bytes;
+    };
 
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
-#define CASE(N)                                                                \
-    case N:                                                                    \
-        doCompute<DT<N>::t>(_op, context)
-
-        int dataTypeIdx = _op->getDType().getIndex();
-        switch (dataTypeIdx) {
-            CASE(1); // DataType::Float32
-            break;
-            CASE(12); // DataType::UInt32
-            break;
-        default:
-            IT_TODO_HALT();
+        computePrepared(_op, context);
+    }
+
+    PreparedKernel prepare(const Operator &_op,
+                           const RuntimeObj *context) const override {
+        auto op = as<ConcatObj>(_op);
+        auto output = op->getOutput();
+        const int dim = op->getDim();
+        const size_t elemSize = op->getDType().getSize();
+        const auto &outDim = output->getDims();
+
+        // dim 之前的维度之积为 outer，之后的维度之积为 inner，输出的一行包含 outDim[dim] * inner 个元素
+        size_t outer = 1, inner = 1;
+        for (int i = 0; i < dim; ++i)
+            outer *= outDim[i];
+        for (size_t i = dim + 1; i < outDim.size(); ++i)
+            inner *= outDim[i];
+        const size_t dstRowBytes = outDim[dim] * inner * elemSize;
+        if (outer == 0 || dstRowBytes == 0)
+            return [](void *const *, void *const *) {};
+
+        vector<Piece> pieces;
+        size_t dstOffset = 0;
+        for (size_t i = 0; i < op->getInputs().size(); ++i) {
+            size_t rowBytes = op->getInputs(i)->getDims()[dim] * inner * elemSize;
+            for (size_t begin = 0; begin < rowBytes; begin += kConcatChunkBytes)
+                pieces.push_back({i, rowBytes, begin, dstOffset + begin,
+                                  std::min(kConcatChunkBytes, rowBytes - begin)});
+            dstOffset += rowBytes;
         }
+
+        const size_t totalBytes = outer * dstRowBytes;
+        const bool stream = totalBytes > getConcatStreamThreshold();
+        const size_t tasks = outer * pieces.size();
+        ThreadPool *pool = context->getThreadPool();
+        const size_t chunks =
+            totalBytes >= kConcatParallelBytes ? std::min<size_t>(getNumThreads(pool), tasks) : 1;
+        return [=, pieces = std::move(pieces)](void *const *inputs, void *const *outputs) {
+            uint8_t *dst = static_cast<uint8_t *>(outputs[0]);
+            // 每个线程依次处理连续的一段拷贝任务
+            parallelFor(pool, chunks, [&](size_t chunk) {
+                for (size_t t = tasks * chunk / chunks; t < tasks * (chunk + 1) / chunks; ++t) {
+                    const auto &piece = pieces[t % pieces.size()];
+                    size_t row = t / pieces.size();
+                    uint8_t *to = dst + row * dstRowBytes + piece.dstOffset;
+                    const uint8_t *from =
+                        static_cast<const uint8_t *>(inputs[piece.input]) + row * piece.srcRowBytes + piece.srcOffset;
+                    if (stream && piece.bytes >= kConcatStreamBytes)
+                        streamCopy(to, from, piece.bytes);
+                    else
+                        std::memcpy(to, from, piece.bytes);
+                }
+#if defined(__x86_64__)
+                if (stream)
+                    _mm_sfence();
+#endif
+            });
+        };
     }
 };
 
-REGISTER_KERNEL(Device::CPU, OpType::Concat, NaiveConcat, "ConcatNaive_CPU");
+REGISTER_KERNEL(Device::CPU, OpType::Concat, NativeConcat, "ConcatMemcpy_CPU");
 
 } // namespace infini
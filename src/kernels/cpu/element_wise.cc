@@ -1,119 +1,78 @@
 #include "operators/element_wise.h"
 #include "core/kernel.h"
-#include "utils/operator_utils.h"
+#include "kernels/cpu/element_wise.h"
 
 namespace infini
 {
+    // 每个数据类型在编译期实例化一份，执行时不再按数据类型分派
+    template <int DType>
     class NativeElementWise : public CpuKernelWithoutConfig
     {
-        template <typename T>
-        static T addCompute(T val0, T val1)
-        {
-            return val0 + val1;
-        }
+        using T = typename DT<DType>::t;
 
-        template <typename T>
-        static T subCompute(T val0, T val1)
+        struct AddOp
         {
-            return val0 - val1;
-        }
+            T operator()(T val0, T val1) const { return val0 + val1; }
+        };
 
-        template <typename T>
-        static T mulCompute(T val0, T val1)
+        struct SubOp
         {
-            return val0 * val1;
-        }
+            T operator()(T val0, T val1) const { return val0 - val1; }
+        };
 
-        template <typename T>
-        static T divCompute(T val0, T val1)
+        struct MulOp
         {
-            return (T)(val0 / val1);
-        }
+            T operator()(T val0, T val1) const { return val0 * val1; }
+        };
 
-        template <typename T>
-        void doCompute(const Operator &_op, const RuntimeObj *context) const
+        struct DivOp
         {
-            auto op = as<ElementWiseObj>(_op);
-            T *inptr0 = op->getInputs(0)->getRawDataPtr<T *>();
-            T *inptr1 = op->getInputs(1)->getRawDataPtr<T *>();
-            T *outptr = op->getOutput()->getRawDataPtr<T *>();
+            T operator()(T val0, T val1) const { return (T)(val0 / val1); }
+        };
 
-            auto shapeA = op->getInputs(0)->getDims();
-            auto shapeB = op->getInputs(1)->getDims();
-            auto shapeC = op->getOutput()->getDims();
-            auto rank = op->getOutput()->getRank();
-            Shape a(rank, 1);
-            Shape b(rank, 1);
-            std::copy(shapeA.begin(), shapeA.end(),
-                      a.begin() + (rank - shapeA.size()));
-            std::copy(shapeB.begin(), shapeB.end(),
-                      b.begin() + (rank - shapeB.size()));
-            auto getStride = [&](const Shape &shape)
+        // 广播方案在编译执行计划时生成一次
+        template <typename Op>
+        static PreparedKernel prepare(const Ref<ElementWiseObj> &op, ThreadPool *pool)
+        {
+            auto plan = make_broadcast_plan<2>(
+                op->getOutput()->getDims(),
+                {op->getInputs(0)->getDims(), op->getInputs(1)->getDims()});
+            return [plan, pool](void *const *inputs, void *const *outputs)
             {
-                int p = 1;
-                Shape stride(rank);
-                for (auto i = rank; i > 0; --i)
-                {
-                    stride[i - 1] = p;
-                    p = p * shape[i - 1];
-                }
-                return stride;
+                elementWiseBinary<T>(pool, Op(), static_cast<const T *>(inputs[0]), static_cast<const T *>(inputs[1]),
+                                     static_cast<T *>(outputs[0]), plan);
             };
-            Shape strideA = getStride(a);
-            Shape strideB = getStride(b);
+        }
 
-            auto n = op->getOutput()->size();
-            T (*_doCompute)
-            (T val0, T val1);
+        PreparedKernel prepare(const Operator &_op,
+                               const RuntimeObj *context) const override
+        {
+            auto op = as<ElementWiseObj>(_op);
+            ThreadPool *pool = context->getThreadPool();
             switch (op->getOpType().underlying())
             {
             case OpType::Add:
-                _doCompute = addCompute<T>;
-                break;
+                return prepare<AddOp>(op, pool);
             case OpType::Sub:
-                _doCompute = subCompute<T>;
-                break;
+                return prepare<SubOp>(op, pool);
             case OpType::Mul:
-                _doCompute = mulCompute<T>;
-                break;
+                return prepare<MulOp>(op, pool);
             case OpType::Div:
-                _doCompute = divCompute<T>;
-                break;
+                return prepare<DivOp>(op, pool);
             default:
                 IT_TODO_HALT();
             }
-
-            for (size_t i = 0; i < n; ++i)
-            {
-                auto shapeIndexC = locate_index(i, shapeC);
-                auto indexA = delocate_index(shapeIndexC, a, strideA);
-                auto indexB = delocate_index(shapeIndexC, b, strideB);
-                outptr[i] = _doCompute(inptr0[indexA], inptr1[indexB]);
-            }
         }
 
         void compute(const Operator &_op,
                      const RuntimeObj *context) const override
         {
-#define CASE(N) \
-    case N:     \
-        doCompute<DT<N>::t>(_op, context)
-
-            int dataTypeIdx = _op->getDType().getIndex();
-            switch (dataTypeIdx)
-            {
-                CASE(1); // DataType::Float32
-                break;
-                CASE(12); // DataType::UInt32
-                break;
-            default:
-                IT_TODO_HALT();
-            }
+            computePrepared(_op, context);
         }
     };
 
-    REGISTER_KERNEL(Device::CPU, OpType::Add, NativeElementWise, "addNaive_CPU");
-    REGISTER_KERNEL(Device::CPU, OpType::Sub, NativeElementWise, "subNaive_CPU");
-    REGISTER_KERNEL(Device::CPU, OpType::Mul, NativeElementWise, "mulNaive_CPU");
-    REGISTER_KERNEL(Device::CPU, OpType::Div, NativeElementWise, "divNaive_CPU");
+    REGISTER_KERNEL_TYPES(Device::CPU, OpType::Add, NativeElementWise, "addNaive_CPU", ELEMENT_WISE_DTYPES);
+    REGISTER_KERNEL_TYPES(Device::CPU, OpType::Sub, NativeElementWise, "subNaive_CPU", ELEMENT_WISE_DTYPES);
+    REGISTER_KERNEL_TYPES(Device::CPU, OpType::Mul, NativeElementWise, "mulNaive_CPU", ELEMENT_WISE_DTYPES);
+    REGISTER_KERNEL_TYPES(Device::CPU, OpType::Div, NativeElementWise, "divNaive_CPU", ELEMENT_WISE_DTYPES);
 }; // namespace infini
@@ -0,0 +1,365 @@
+#include "kernels/cpu/gemm.h"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include "utils/cpu_info.h"
+
+namespace infini {
+
+// 所有微内核中最大的寄存器分块，用于在栈上开辟处理边界块的临时缓冲
+constexpr int kMaxMR = 8;
+constexpr int kMaxNR = 32;
+
+// 将 mr x nr 的临时结果写回（或累加回）只有 m x n 个有效元素的边界块
+static void storeEdgeTile(const float *tile, int nr, float *c, size_t ldc, int m, int n, bool accumulate) {
+    for (int i = 0; i < m; ++i) {
+        if (accumulate) {
+            for (int j = 0; j < n; ++j)
+                c[i * ldc + j] += tile[i * nr + j];
+        } else {
+            std::memcpy(c + i * ldc, tile + i * nr, n * sizeof(float));
+        }
+    }
+}
+
+template <int MR, int NR>
+static void sgemmMicroGeneric(int kc, const float *a, const float *b, float *c, size_t ldc, bool accumulate) {
+    float acc[MR][NR] = {};
+    for (int p = 0; p < kc; ++p) {
+        for (int i = 0; i < MR; ++i) {
+            float ai = a[p * MR + i];
+#pragma omp simd
+            for (int j = 0; j < NR; ++j)
+                acc[i][j] += ai * b[p * NR + j];
+        }
+    }
+    for (int i = 0; i < MR; ++i) {
+        for (int j = 0; j < NR; ++j)
+            c[i * ldc + j] = accumulate ? c[i * ldc + j] + acc[i][j] : acc[i][j];
+    }
+}
+
+#if defined(__x86_64__)
+// 6x16 微内核：12 个 ymm 累加器，每个 k 读取 2 个 B 向量并广播 6 个 A 元素
+__attribute__((target("avx2,fma"))) static void sgemmMicroAvx2(int kc, const float *a, const float *b, float *c,
+                                                             size_t ldc, bool accumulate) {
+    __m256 acc[6][2];
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i)
+        acc[i][0] = acc[i][1] = _mm256_setzero_ps();
+    for (int p = 0; p < kc; ++p) {
+        __m256 b0 = _mm256_loadu_ps(b + p * 16);
+        __m256 b1 = _mm256_loadu_ps(b + p * 16 + 8);
+#pragma GCC unroll 6
+        for (int i = 0; i < 6; ++i) {
+            __m256 ai = _mm256_broadcast_ss(a + p * 6 + i);
+            acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+        }
+    }
+#pragma GCC unroll 6
+    for (int i = 0; i < 6; ++i) {
+        float *ci = c + i * ldc;
+        if (accumulate) {
+            acc[i][0] = _mm256_add_ps(acc[i][0], _mm256_loadu_ps(ci));
+            acc[i][1] = _mm256_add_ps(acc[i][1], _mm256_loadu_ps(ci + 8));
+        }
+        _mm256_storeu_ps(ci, acc[i][0]);
+        _mm256_storeu_ps(ci + 8, acc[i][1]);
+    }
+}
+
+// 8x32 微内核：16 个 zmm 累加器，每个 k 读取 2 个 B 向量并广播 8 个 A 元素
+__attribute__((target("avx512f"))) static void sgemmMicroAvx512(int kc, const float *a, const float *b, float *c,
+                                                              size_t ldc, bool accumulate) {
+    __m512 acc[8][2];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i)
+        acc[i][0] = acc[i][1] = _mm512_setzero_ps();
+    for (int p = 0; p < kc; ++p) {
+        __m512 b0 = _mm512_loadu_ps(b + p * 32);
+        __m512 b1 = _mm512_loadu_ps(b + p * 32 + 16);
+#pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) {
+            __m512 ai = _mm512_set1_ps(a[p * 8 + i]);
+            acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+        }
+    }
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) {
+        float *ci = c + i * ldc;
+        if (accumulate) {
+            acc[i][0] = _mm512_add_ps(acc[i][0], _mm512_loadu_ps(ci));
+            acc[i][1] = _mm512_add_ps(acc[i][1], _mm512_loadu_ps(ci + 16));
+        }
+        _mm512_storeu_ps(ci, acc[i][0]);
+        _mm512_storeu_ps(ci + 16, acc[i][1]);
+    }
+}
+#endif
+
+const vector<SgemmKernelInfo> &getSgemmKernels() {
+    static const vector<SgemmKernelInfo> kernels = [] {
+        vector<SgemmKernelInfo> ret;
+        ret.push_back({"generic_4x8", 4, 8, 64, 256, 2048, sgemmMicroGeneric<4, 8>});
+#if defined(__x86_64__)
+        const auto &features = getCpuFeatures();
+        if (features.avx2 && features.fma)
+            ret.push_back({"avx2_6x16", 6, 16, 96, 256, 4096, sgemmMicroAvx2});
+        if (features.avx512f)
+            ret.push_back({"avx512_8x32", 8, 32, 128, 256, 4096, sgemmMicroAvx512});
+#endif
+        return ret;
+    }();
+    return kernels;
+}
+
+const SgemmKernelInfo &getSgemmKernel() { return getSgemmKernels().back(); }
+
+// 将 op(A) 中 [mc x kc] 的块按 mr 行一组打包，不足 mr 行的部分补 0
+static void packA(const SgemmKernelInfo &info, bool transA, int mc, int kc, const float *A, size_t lda,
+                  float *packed) {
+    const int mr = info.mr;
+    for (int ir = 0; ir < mc; ir += mr) {
+        int rows = std::min(mr, mc - ir);
+        float *dst = packed + (size_t)ir * kc;
+        if (transA) {
+            // A 按 [k x m] 存放，同一个 k 的 mr 个元素是连续的
+            for (int p = 0; p < kc; ++p) {
+                const float *src = A + (size_t)p * lda + ir;
+                for (int i = 0; i < rows; ++i)
+                    dst[p * mr + i] = src[i];
+                for (int i = rows; i < mr; ++i)
+                    dst[p * mr + i] = 0.f;
+            }
+        } else {
+            for (int i = 0; i < rows; ++i) {
+                const float *src = A + (size_t)(ir + i) * lda;
+                for (int p = 0; p < kc; ++p)
+                    dst[p * mr + i] = src[p];
+            }
+            for (int i = rows; i < mr; ++i)
+                for (int p = 0; p < kc; ++p)
+                    dst[p * mr + i] = 0.f;
+        }
+    }
+}
+
+// 将 op(B) 中 [kc x nc] 的块按 nr 列一组打包，不足 nr 列的部分补 0
+static void packB(const SgemmKernelInfo &info, bool transB, int kc, int nc, const float *B, size_t ldb,
+                  float *packed) {
+    const int nr = info.nr;
+    for (int jr = 0; jr < nc; jr += nr) {
+        int cols = std::min(nr, nc - jr);
+        float *dst = packed + (size_t)jr * kc;
+        if (transB) {
+            // B 按 [n x k] 存放，同一列的 k 个元素是连续的
+            for (int j = 0; j < cols; ++j) {
+                const float *src = B + (size_t)(jr + j) * ldb;
+                for (int p = 0; p < kc; ++p)
+                    dst[p * nr + j] = src[p];
+            }
+            for (int j = cols; j < nr; ++j)
+                for (int p = 0; p < kc; ++p)
+                    dst[p * nr + j] = 0.f;
+        } else {
+            for (int p = 0; p < kc; ++p) {
+                const float *src = B + (size_t)p * ldb + jr;
+                std::memcpy(dst + p * nr, src, cols * sizeof(float));
+                for (int j = cols; j < nr; ++j)
+                    dst[p * nr + j] = 0.f;
+            }
+        }
+    }
+}
+
+// 每个线程各自持有的打包缓冲，避免每次调用都重新分配
+static float *getPackBuffer(int which, size_t size) {
+    struct Buffer {
+        std::unique_ptr<float[]> data;
+        size_t size = 0;
+    };
+    static thread_local Buffer buffers[2];
+    auto &buffer = buffers[which];
+    if (buffer.size < size) {
+        buffer.data.reset(new float[size]);
+        buffer.size = size;
+    }
+    return buffer.data.get();
+}
+
+static int roundUp(int x, int align) { return (x + align - 1) / align * align; }
+
+size_t sgemmPackedBSize(const SgemmKernelInfo &info, int k, int n) {
+    // 只有最后一个 nc 列块可能不足 nc 列，按 nr 补齐即可
+    return (size_t)k * roundUp(n, info.nr);
+}
+
+void sgemmPackB(const SgemmKernelInfo &info, bool transB, int k, int n, const float *B, size_t ldb, float *packed) {
+    for (int jc = 0; jc < n; jc += info.nc) {
+        int nc = std::min(info.nc, n - jc);
+        for (int pc = 0; pc < k; pc += info.kc) {
+            int kc = std::min(info.kc, k - pc);
+            const float *blockB = transB ? B + (size_t)jc * ldb + pc : B + (size_t)pc * ldb + jc;
+            packB(info, transB, kc, nc, blockB, ldb, packed + (size_t)jc * k + (size_t)pc * roundUp(nc, info.nr));
+        }
+    }
+}
+
+void sgemm(const SgemmKernelInfo &info, bool transA, bool transB, int m, int n, int k, const float *A, size_t lda,
+           const float *B, size_t ldb, float *C, size_t ldc, const float *packedB) {
+    if (m <= 0 || n <= 0) return;
+    if (k <= 0) {
+        for (int i = 0; i < m; ++i)
+            std::memset(C + i * ldc, 0, n * sizeof(float));
+        return;
+    }
+    const int mr = info.mr, nr = info.nr;
+    const int MC = info.mc, KC = info.kc, NC = info.nc;
+    float *bufA = getPackBuffer(0, (size_t)MC * KC);
+    float *bufB = packedB ? nullptr : getPackBuffer(1, (size_t)KC * NC);
+    alignas(64) float tile[kMaxMR * kMaxNR];
+
+    for (int jc = 0; jc < n; jc += NC) {
+        int nc = std::min(NC, n - jc);
+        for (int pc = 0; pc < k; pc += KC) {
+            int kc = std::min(KC, k - pc);
+            bool accumulate = pc > 0;
+            const float *panelB = bufB;
+            if (packedB) {
+                // 与 sgemmPackB 的存放顺序一致：第 jc 个列块之前共有 jc * k 个元素
+                panelB = packedB + (size_t)jc * k + (size_t)pc * roundUp(nc, nr);
+            } else {
+                const float *blockB = transB ? B + (size_t)jc * ldb + pc : B + (size_t)pc * ldb + jc;
+                packB(info, transB, kc, nc, blockB, ldb, bufB);
+            }
+            for (int ic = 0; ic < m; ic += MC) {
+                int mc = std::min(MC, m - ic);
+                const float *blockA = transA ? A + (size_t)pc * lda + ic : A + (size_t)ic * lda + pc;
+                packA(info, transA, mc, kc, blockA, lda, bufA);
+                for (int jr = 0; jr < nc; jr += nr) {
+                    int cols = std::min(nr, nc - jr);
+                    for (int ir = 0; ir < mc; ir += mr) {
+                        int rows = std::min(mr, mc - ir);
+                        float *c = C + (size_t)(ic + ir) * ldc + jc + jr;
+                        const float *a = bufA + (size_t)ir * kc;
+                        const float *b = panelB + (size_t)jr * kc;
+                        if (rows == mr && cols == nr) {
+                            info.microKernel(kc, a, b, c, ldc, accumulate);
+                        } else {
+                            info.microKernel(kc, a, b, tile, nr, false);
+                            storeEdgeTile(tile, nr, c, ldc, rows, cols, accumulate);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void partitionMatrix(int parts, int m, int n, int mr, int nr, int &mTiles, int &nTiles) {
+    mTiles = nTiles = 1;
+    const int maxMTiles = (m + mr - 1) / mr, maxNTiles = (n + nr - 1) / nr;
+    for (; parts > 1; --parts) {
+        bool found = false;
+        double bestScore = 0;
+        for (int mt = 1; mt <= parts; ++mt) {
+            if (parts % mt != 0) continue;
+            int nt = parts / mt;
+            if (mt > maxMTiles || nt > maxNTiles) continue;
+            // 子块越接近正方形，打包数据的复用率越高；分数相同时优先沿 N 划分，避免重复打包 B
+            double score = -std::fabs(std::log(((double)m / mt) / ((double)n / nt)));
+            if (!found || score > bestScore || (score == bestScore && nt > nTiles)) {
+                found = true;
+                bestScore = score;
+                mTiles = mt;
+                nTiles = nt;
+            }
+        }
+        if (found) return;
+    }
+}
+
+void sgemmBatched(const SgemmKernelInfo &info, bool transA, bool transB, int m, int n, int k,
+                  const vector<int> &batchShape, const vector<size_t> &stridesA, const vector<size_t> &stridesB,
+                  const float *A, const float *B, float *C, const float *packedB, ThreadPool *pool) {
+    if (m <= 0 || n <= 0) return;
+    // 预先计算每个 batch 中 A、B 的偏移量，广播的维度跨度为 0，不会拷贝数据
+    auto offsetsA = getBatchOffsets(batchShape, stridesA), offsetsB = getBatchOffsets(batchShape, stridesB);
+    const size_t batch = offsetsA.size();
+    if (batch == 0) return;  // 某个 batch 维度为 0，输出为空
+
+    const size_t lda = transA ? m : k, ldb = transB ? k : n, ldc = n;
+    const int threads = getNumThreads(pool);
+    // batch 数不足以分给所有线程时，再把每个矩阵划分成 M x N 的子块
+    int mTiles = 1, nTiles = 1;
+    if ((size_t)threads > batch) {
+        int parts = (threads + batch - 1) / batch;
+        if (packedB)
+            // B 已经预打包，沿 M 划分不会重复打包 B，也不需要处理列块内的偏移
+            mTiles = std::min(parts, (m + info.mr - 1) / info.mr);
+        else
+            partitionMatrix(parts, m, n, info.mr, info.nr, mTiles, nTiles);
+    }
+    const int tileM = ((m + mTiles - 1) / mTiles + info.mr - 1) / info.mr * info.mr;
+    const int tileN = ((n + nTiles - 1) / nTiles + info.nr - 1) / info.nr * info.nr;
+    mTiles = (m + tileM - 1) / tileM;
+    nTiles = (n + tileN - 1) / tileN;
+    const long tasks = (long)batch * mTiles * nTiles;
+    const size_t packedSize = packedB ? sgemmPackedBSize(info, k, n) : 0;
+
+    parallelFor(pool, tasks, [&](size_t t) {
+        size_t b = t / (mTiles * nTiles);
+        int m0 = (t / nTiles) % mTiles * tileM, n0 = t % nTiles * tileN;
+        int mc = std::min(tileM, m - m0), nc = std::min(tileN, n - n0);
+        const float *a = A + offsetsA[b] + (transA ? (size_t)m0 : (size_t)m0 * lda);
+        const float *bb = B + offsetsB[b] + (transB ? (size_t)n0 * ldb : (size_t)n0);
+        float *c = C + b * m * n + (size_t)m0 * ldc + n0;
+        const float *packed = packedB ? packedB + offsetsB[b] / ((size_t)k * n) * packedSize : nullptr;
+        sgemm(info, transA, transB, mc, nc, k, a, lda, bb, ldb, c, ldc, packed);
+    });
+}
+
+vector<size_t> getMatmulBatchStrides(const vector<int> &batchShape, const vector<int> &dims, size_t matrixSize) {
+    IT_ASSERT(dims.size() >= 2 && dims.size() - 2 <= batchShape.size());
+    vector<size_t> strides(batchShape.size(), 0);
+    size_t stride = matrixSize;
+    int offset = batchShape.size() - (dims.size() - 2);
+    for (int i = (int)dims.size() - 3; i >= 0; --i) {
+        if (dims[i] != 1)
+            strides[i + offset] = stride;
+        stride *= dims[i];
+    }
+    return strides;
+}
+
+vector<size_t> getBatchOffsets(const vector<int> &batchShape, const vector<size_t> &strides) {
+    IT_ASSERT(strides.size() == batchShape.size());
+    size_t batch = 1;
+    for (auto d : batchShape)
+        batch *= d;
+    // 按行主序逐个递增 batch 下标，只在进位时回退对应维度的偏移
+    vector<size_t> offsets(batch, 0);
+    vector<int> index(batchShape.size(), 0);
+    for (size_t b = 1; b < batch; ++b) {
+        size_t offset = offsets[b - 1];
+        for (int d = (int)batchShape.size() - 1; d >= 0; --d) {
+            if (++index[d] < batchShape[d]) {
+                offset += strides[d];
+                break;
+            }
+            offset -= strides[d] * (batchShape[d] - 1);
+            index[d] = 0;
+        }
+        offsets[b] = offset;
+    }
+    return offsets;
+}
+
+}  // namespace infini
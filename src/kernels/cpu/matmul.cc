@@ -0,0 +1,146 @@
+#include "operators/matmul.h"
+#include "core/kernel.h"
+#include "kernels/cpu/gemm.h"
+#include "kernels/cpu/qgemm.h"
+
+namespace infini {
+
+class NativeMatmul : public CpuKernelWithoutConfig {
+  protected:
+    SgemmKernelInfo info = getSgemmKernel();  // 使用的微内核及分块参数
+
+  private:
+    PreparedKernel prepareFloat(const Ref<MatmulObj> &op, ThreadPool *pool) const {
+        const int m = op->getM(), n = op->getN(), k = op->getK();
+        const bool transA = op->getTransA(), transB = op->getTransB();
+
+        // 最后两维之前的维度都视为 batch，按照输出的 batch 维度计算 A、B 的跨度，
+        // 秩较低或该维为 1 的操作数在对应维度上跨度为 0，实现广播而不拷贝数据
+        const auto cDims = op->getOutput()->getDims();
+        vector<int> batchShape(cDims.begin(), cDims.end() - 2);
+        auto stridesA = getMatmulBatchStrides(batchShape, op->getInputs(0)->getDims(), (size_t)m * k);
+        auto stridesB = getMatmulBatchStrides(batchShape, op->getInputs(1)->getDims(), (size_t)k * n);
+
+        // 如果 B 是已经预打包的权重，直接使用打包好的面板
+        const auto &blob = op->getPrepackedData();
+        const float *packed = blob ? blob->getPtr<float *>() : nullptr;
+        const SgemmKernelInfo *info = &this->info;
+        return [=](void *const *inputs, void *const *outputs) {
+            sgemmBatched(*info, transA, transB, m, n, k, batchShape, stridesA, stridesB,
+                         static_cast<const float *>(inputs[0]), static_cast<const float *>(inputs[1]),
+                         static_cast<float *>(outputs[0]), packed, pool);
+        };
+    }
+
+    // 只有标记为常量权重的 B 才会预打包（其他输入每次推理都可能改变），B 中的每个矩阵分别打包
+    static bool canPrepack(const Ref<MatmulObj> &op) {
+        return op->getDType() == DataType::Float32 && op->getInputs(1)->isWeight() && op->getN() > 0 &&
+               op->getK() > 0;
+    }
+
+    size_t getPrepackSize(const Operator &_op,
+                          const RuntimeObj *context) const override {
+        auto op = as<MatmulObj>(_op);
+        if (!canPrepack(op))
+            return 0;
+        size_t matrices = op->getInputs(1)->size() / ((size_t)op->getK() * op->getN());
+        return matrices * sgemmPackedBSize(info, op->getK(), op->getN()) * sizeof(float);
+    }
+
+    void prepack(const Operator &_op, const RuntimeObj *context,
+                 void *buffer) const override {
+        auto op = as<MatmulObj>(_op);
+        const int n = op->getN(), k = op->getK();
+        const float *B = op->getInputs(1)->getRawDataPtr<float *>();
+        float *packed = static_cast<float *>(buffer);
+        size_t matrices = op->getInputs(1)->size() / ((size_t)k * n);
+        size_t packedSize = sgemmPackedBSize(info, k, n);
+        for (size_t i = 0; i < matrices; ++i)
+            sgemmPackB(info, op->getTransB(), k, n, B + i * k * n, op->getTransB() ? k : n, packed + i * packedSize);
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        computePrepared(_op, context);
+    }
+
+    PreparedKernel prepare(const Operator &_op,
+                           const RuntimeObj *context) const override {
+        return prepareFloat(as<MatmulObj>(_op), context->getThreadPool());
+    }
+};
+
+/**
+ * @brief 与 NativeMatmul 使用相同的微内核，但 kc 减半、mc 减半、nc 为四分之一：
+ * 较小的矩阵或较小的缓存上打包的面板更容易留在 L1/L2 中，由自动调优决定是否使用
+ */
+class NativeMatmulSmallBlock : public NativeMatmul {
+  public:
+    NativeMatmulSmallBlock() {
+        info.mc /= 2;
+        info.kc /= 2;
+        info.nc /= 4;
+    }
+};
+
+class NativeQuantizedMatmul : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        computePrepared(_op, context);
+    }
+
+    PreparedKernel prepare(const Operator &_op,
+                           const RuntimeObj *context) const override {
+        auto op = as<QuantizedMatmulObj>(_op);
+        const int m = op->getM(), n = op->getN(), k = op->getK();
+        const bool transA = op->getTransA(), transB = op->getTransB();
+        const bool aSigned = op->getInputs(0)->getDType() == DataType::Int8;
+
+        const auto cDims = op->getOutput()->getDims();
+        vector<int> batchShape(cDims.begin(), cDims.end() - 2);
+        auto stridesA = getMatmulBatchStrides(batchShape, op->getInputs(0)->getDims(), (size_t)m * k);
+        auto stridesB = getMatmulBatchStrides(batchShape, op->getInputs(1)->getDims(), (size_t)k * n);
+
+        // 量化参数中的指针指向算子自身保存的数组，算子在执行计划中一直存活
+        QgemmQuantParams params{op->getScaleA(), op->getZeroPointA(), op->getScaleB().data(),
+                                op->getZeroPointB().data(), op->isPerChannel()};
+        const auto &blob = op->getPrepackedData();
+        const void *packed = blob ? blob->getPtr<void *>() : nullptr;
+        const QgemmKernelInfo *info = &getQgemmKernel();
+        ThreadPool *pool = context->getThreadPool();
+        return [=](void *const *inputs, void *const *outputs) {
+            qgemmBatched(*info, transA, transB, m, n, k, batchShape, stridesA, stridesB, inputs[0], aSigned,
+                         static_cast<const int8_t *>(inputs[1]), static_cast<float *>(outputs[0]), params, packed, pool);
+        };
+    }
+
+    // 与浮点矩阵乘相同，只预打包标记为常量权重的 B，打包结果中包含每列的累加和
+    size_t getPrepackSize(const Operator &_op,
+                          const RuntimeObj *context) const override {
+        auto op = as<QuantizedMatmulObj>(_op);
+        if (!op->getInputs(1)->isWeight() || op->getN() == 0 || op->getK() == 0)
+            return 0;
+        size_t matrices = op->getInputs(1)->size() / ((size_t)op->getK() * op->getN());
+        return matrices * qgemmPackedBSize(getQgemmKernel(), op->getK(), op->getN());
+    }
+
+    void prepack(const Operator &_op, const RuntimeObj *context,
+                 void *buffer) const override {
+        auto op = as<QuantizedMatmulObj>(_op);
+        const int n = op->getN(), k = op->getK();
+        const auto &info = getQgemmKernel();
+        const int8_t *B = op->getInputs(1)->getRawDataPtr<int8_t *>();
+        size_t matrices = op->getInputs(1)->size() / ((size_t)k * n);
+        size_t packedSize = qgemmPackedBSize(info, k, n);
+        for (size_t i = 0; i < matrices; ++i)
+            qgemmPackB(info, op->getTransB(), k, n, B + i * k * n, op->getTransB() ? k : n,
+                       static_cast<uint8_t *>(buffer) + i * packedSize);
+    }
+};
+
+// 浮点矩阵乘只支持 Float32；量化矩阵乘的 A 为 UInt8 或 Int8
+REGISTER_KERNEL_TYPES(Device::CPU, OpType::MatMul, NativeMatmul, "MatmulGemm_CPU", 1);
+REGISTER_KERNEL_TYPES(Device::CPU, OpType::MatMul, NativeMatmulSmallBlock, "MatmulGemmSmallBlock_CPU", 1);
+REGISTER_KERNEL_TYPES(Device::CPU, OpType::QuantizedMatMul, NativeQuantizedMatmul, "QuantizedMatmulGemm_CPU", 2, 3);
+
+} // namespace infini
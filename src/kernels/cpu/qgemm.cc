@@ -0,0 +1,227 @@
+#include "kernels/cpu/qgemm.h"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "kernels/cpu/gemm.h"
+#include "utils/cpu_info.h"
+
+namespace infini {
+
+constexpr int kMaxMR = 8;
+constexpr int kMaxNR = 32;
+
+static int roundUp(int x, int align) { return (x + align - 1) / align * align; }
+
+template <int MR, int NR>
+static void qgemmMicroGeneric(int kq, const uint8_t *a, const int8_t *b, int32_t *tile) {
+    int32_t acc[MR][NR] = {};
+    for (int q = 0; q < kq; ++q) {
+        for (int i = 0; i < MR; ++i) {
+            const uint8_t *ai = a + (q * MR + i) * 4;
+            for (int j = 0; j < NR; ++j) {
+                const int8_t *bj = b + (q * NR + j) * 4;
+                acc[i][j] += ai[0] * bj[0] + ai[1] * bj[1] + ai[2] * bj[2] + ai[3] * bj[3];
+            }
+        }
+    }
+    std::memcpy(tile, acc, sizeof(acc));
+}
+
+#if defined(__x86_64__)
+// 8x32 微内核：16 个 zmm 累加器，每组读取 2 个 B 向量（32 列 x 4 字节），
+// 广播 A 中每一行的 4 个字节，用 vpdpbusd 一次完成 4 个 u8 x s8 乘积的累加
+__attribute__((target("avx512f,avx512vnni"))) static void qgemmMicroAvx512Vnni(int kq, const uint8_t *a,
+                                                                               const int8_t *b, int32_t *tile) {
+    __m512i acc[8][2];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i)
+        acc[i][0] = acc[i][1] = _mm512_setzero_si512();
+    for (int q = 0; q < kq; ++q) {
+        __m512i b0 = _mm512_loadu_si512(b + q * 128);
+        __m512i b1 = _mm512_loadu_si512(b + q * 128 + 64);
+#pragma GCC unroll 8
+        for (int i = 0; i < 8; ++i) {
+            int32_t ai;
+            std::memcpy(&ai, a + (q * 8 + i) * 4, sizeof(ai));
+            __m512i va = _mm512_set1_epi32(ai);
+            acc[i][0] = _mm512_dpbusd_epi32(acc[i][0], va, b0);
+            acc[i][1] = _mm512_dpbusd_epi32(acc[i][1], va, b1);
+        }
+    }
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; ++i) {
+        _mm512_storeu_si512(tile + i * 32, acc[i][0]);
+        _mm512_storeu_si512(tile + i * 32 + 16, acc[i][1]);
+    }
+}
+#endif
+
+const vector<QgemmKernelInfo> &getQgemmKernels() {
+    static const vector<QgemmKernelInfo> kernels = [] {
+        vector<QgemmKernelInfo> ret;
+        ret.push_back({"generic_4x8", 4, 8, qgemmMicroGeneric<4, 8>});
+#if defined(__x86_64__)
+        if (getCpuFeatures().avx512vnni)
+            ret.push_back({"avx512vnni_8x32", 8, 32, qgemmMicroAvx512Vnni});
+#endif
+        return ret;
+    }();
+    return kernels;
+}
+
+const QgemmKernelInfo &getQgemmKernel() { return getQgemmKernels().back(); }
+
+// 将 op(A) 的 m 行打包为 uint8 面板（k 维补齐到 4 的倍数），同时计算每行的累加和
+static void packA(const QgemmKernelInfo &info, bool transA, bool aSigned, int m, int k, const uint8_t *A,
+                  size_t lda, uint8_t *packed, int32_t *rowSums) {
+    const int mr = info.mr, kp = roundUp(k, 4);
+    // int8 加上 128 后转换为 uint8，零点也会相应加上 128
+    const uint8_t flip = aSigned ? 0x80 : 0;
+    for (int ir = 0; ir < roundUp(m, mr); ir += mr) {
+        uint8_t *dst = packed + (size_t)ir * kp;
+        for (int i = 0; i < mr; ++i) {
+            int32_t sum = 0;
+            for (int p = 0; p < kp; ++p) {
+                uint8_t v = 0;
+                if (ir + i < m && p < k)
+                    v = (transA ? A[(size_t)p * lda + ir + i] : A[(size_t)(ir + i) * lda + p]) ^ flip;
+                dst[(p / 4 * mr + i) * 4 + p % 4] = v;
+                sum += v;
+            }
+            if (ir + i < m)
+                rowSums[ir + i] = sum;
+        }
+    }
+}
+
+// 将 op(B) 的 n 列打包为 VNNI 面板（补齐到 nr 列），同时计算每列的累加和
+static void packB(const QgemmKernelInfo &info, bool transB, int k, int n, const int8_t *B, size_t ldb,
+                  int8_t *panels, int32_t *colSums) {
+    const int nr = info.nr, kp = roundUp(k, 4);
+    for (int jr = 0; jr < roundUp(n, nr); jr += nr) {
+        int8_t *dst = panels + (size_t)jr * kp;
+        for (int j = 0; j < nr; ++j) {
+            int32_t sum = 0;
+            for (int p = 0; p < kp; ++p) {
+                int8_t v = 0;
+                if (jr + j < n && p < k)
+                    v = transB ? B[(size_t)(jr + j) * ldb + p] : B[(size_t)p * ldb + jr + j];
+                dst[(p / 4 * nr + j) * 4 + p % 4] = v;
+                sum += v;
+            }
+            colSums[jr + j] = sum;
+        }
+    }
+}
+
+size_t qgemmPackedBSize(const QgemmKernelInfo &info, int k, int n) {
+    size_t np = roundUp(n, info.nr);
+    return np * roundUp(k, 4) + np * sizeof(int32_t);
+}
+
+void qgemmPackB(const QgemmKernelInfo &info, bool transB, int k, int n, const int8_t *B, size_t ldb, void *packed) {
+    auto panels = static_cast<int8_t *>(packed);
+    auto colSums = reinterpret_cast<int32_t *>(panels + (size_t)roundUp(n, info.nr) * roundUp(k, 4));
+    packB(info, transB, k, n, B, ldb, panels, colSums);
+}
+
+// 每个线程各自持有的打包缓冲
+static void *getPackBuffer(int which, size_t size) {
+    struct Buffer {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+    };
+    static thread_local Buffer buffers[4];
+    auto &buffer = buffers[which];
+    if (buffer.size < size) {
+        buffer.data.reset(new uint8_t[size]);
+        buffer.size = size;
+    }
+    return buffer.data.get();
+}
+
+void qgemmBatched(const QgemmKernelInfo &info, bool transA, bool transB, int m, int n, int k,
+                  const vector<int> &batchShape, const vector<size_t> &stridesA, const vector<size_t> &stridesB,
+                  const void *A, bool aSigned, const int8_t *B, float *C, const QgemmQuantParams &params,
+                  const void *packedB, ThreadPool *pool) {
+    if (m <= 0 || n <= 0) return;
+    auto offsetsA = getBatchOffsets(batchShape, stridesA), offsetsB = getBatchOffsets(batchShape, stridesB);
+    const size_t batch = offsetsA.size();
+    if (batch == 0) return;  // 某个 batch 维度为 0，输出为空
+    const int mr = info.mr, nr = info.nr;
+    const int kp = roundUp(k, 4), np = roundUp(n, nr);
+    const size_t lda = transA ? m : k, ldb = transB ? k : n;
+    const size_t packedSize = qgemmPackedBSize(info, k, n);
+    const int32_t zeroPointA = params.zeroPointA + (aSigned ? 128 : 0);
+
+    // 与 sgemmBatched 相同：batch 数不足以分给所有线程时，再把每个矩阵划分成 M x N 的子块。
+    // 每个任务只打包自己负责的 A 的行和 B 的列；B 已经预打包时只沿 M 划分，A 的每一行只打包一次
+    const int threads = getNumThreads(pool);
+    int mTiles = 1, nTiles = 1;
+    if ((size_t)threads > batch) {
+        int parts = (threads + batch - 1) / batch;
+        if (packedB)
+            mTiles = std::min(parts, (m + mr - 1) / mr);
+        else
+            partitionMatrix(parts, m, n, mr, nr, mTiles, nTiles);
+    }
+    const int tileM = roundUp((m + mTiles - 1) / mTiles, mr), tileN = roundUp((n + nTiles - 1) / nTiles, nr);
+    mTiles = (m + tileM - 1) / tileM;
+    nTiles = (n + tileN - 1) / tileN;
+    const long tasks = (long)batch * mTiles * nTiles;
+
+    parallelFor(pool, tasks, [&](size_t t) {
+        size_t b = t / (mTiles * nTiles);
+        int m0 = (t / nTiles) % mTiles * tileM, n0 = t % nTiles * tileN;
+        int m1 = std::min(m, m0 + tileM), n1 = std::min(n, n0 + tileN);
+
+        auto panelsA = static_cast<uint8_t *>(getPackBuffer(0, (size_t)roundUp(m1 - m0, mr) * kp));
+        auto rowSums = static_cast<int32_t *>(getPackBuffer(1, (m1 - m0) * sizeof(int32_t)));
+        const uint8_t *blockA = static_cast<const uint8_t *>(A) + offsetsA[b] + (transA ? (size_t)m0 : (size_t)m0 * lda);
+        packA(info, transA, aSigned, m1 - m0, k, blockA, lda, panelsA, rowSums);
+
+        const int8_t *panelsB;
+        const int32_t *colSums;
+        if (packedB) {
+            auto base = static_cast<const int8_t *>(packedB) + offsetsB[b] / ((size_t)k * n) * packedSize;
+            panelsB = base + (size_t)n0 * kp;
+            colSums = reinterpret_cast<const int32_t *>(base + (size_t)np * kp) + n0;
+        } else {
+            int cols = roundUp(n1 - n0, nr);
+            auto bufPanels = static_cast<int8_t *>(getPackBuffer(2, (size_t)cols * kp));
+            auto bufSums = static_cast<int32_t *>(getPackBuffer(3, cols * sizeof(int32_t)));
+            const int8_t *blockB = B + offsetsB[b] + (transB ? (size_t)n0 * ldb : (size_t)n0);
+            packB(info, transB, k, n1 - n0, blockB, ldb, bufPanels, bufSums);
+            panelsB = bufPanels;
+            colSums = bufSums;
+        }
+
+        alignas(64) int32_t tile[kMaxMR * kMaxNR];
+        float *c = C + b * m * n + (size_t)m0 * n;
+        for (int jr = n0; jr < n1; jr += nr) {
+            int cols = std::min(nr, n1 - jr);
+            for (int ir = 0; ir < m1 - m0; ir += mr) {
+                int rows = std::min(mr, m1 - m0 - ir);
+                info.microKernel(kp / 4, panelsA + (size_t)ir * kp, panelsB + (size_t)(jr - n0) * kp, tile);
+                // 尾处理：扣除零点的影响后反量化
+                // sum((a - za)(b - zb)) = sum(ab) - zb * sum(a) - za * sum(b) + k * za * zb
+                for (int j = 0; j < cols; ++j) {
+                    int col = jr + j;
+                    int64_t zeroPointB = params.zeroPointB[params.perChannel ? col : 0];
+                    float scale = params.scaleA * params.scaleB[params.perChannel ? col : 0];
+                    int64_t colTerm = (int64_t)zeroPointA * colSums[col - n0] - (int64_t)k * zeroPointA * zeroPointB;
+                    for (int i = 0; i < rows; ++i) {
+                        int64_t acc = tile[i * nr + j] - zeroPointB * rowSums[ir + i] - colTerm;
+                        c[(size_t)(ir + i) * n + col] = scale * (float)acc;
+                    }
+                }
+            }
+        }
+    });
+}
+
+}  // namespace infini
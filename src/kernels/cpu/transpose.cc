@@ -1,59 +1,319 @@
 #include "operators/transpose.h"
 #include "core/kernel.h"
+#include "utils/cpu_info.h"
+#include "utils/thread_pool.h"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
 
 namespace infini {
 
-inline Shape idx2Pos(const Shape &shape, size_t idx) {
-    Shape pos = Shape(shape.size(), 0);
-    auto rest = idx, curDimId = shape.size() - 1;
-    while (rest > 0) {
-        pos[curDimId] = rest % shape[curDimId];
-        rest /= shape[curDimId];
-        curDimId--;
+// 缓存分块的边长（元素个数），一个 4 字节元素的块读写合计约 32KB
+constexpr size_t kTransposeTile = 64;
+
+/**
+ * @brief 去掉长度为 1 的维度，并把在输出中仍然相邻且顺序不变的输入维度合并为一维
+ * @param dims 输入的形状，返回时为合并后的形状
+ * @param perm 输出第 j 维对应的输入维度，返回时为合并后的排列
+ */
+static void simplifyPermute(vector<size_t> &dims, vector<int> &perm) {
+    const int rank = dims.size();
+    vector<int> index(rank, -1);
+    vector<size_t> squeezed;
+    for (int i = 0; i < rank; ++i)
+        if (dims[i] != 1) {
+            index[i] = squeezed.size();
+            squeezed.push_back(dims[i]);
+        }
+    vector<int> squeezedPerm;
+    for (int p : perm)
+        if (index[p] >= 0)
+            squeezedPerm.push_back(index[p]);
+
+    // 按输出顺序把连续递增的输入维度划分为组，每组是输入中的一段 [first, last]
+    vector<std::pair<int, int>> groups;
+    for (int p : squeezedPerm) {
+        if (!groups.empty() && groups.back().second + 1 == p)
+            groups.back().second = p;
+        else
+            groups.push_back({p, p});
+    }
+    // 每组在输入中的先后顺序就是合并后的输入维度编号
+    vector<int> order(groups.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return groups[a].first < groups[b].first; });
+    dims.assign(groups.size(), 1);
+    perm.assign(groups.size(), 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        const auto &group = groups[order[i]];
+        for (int d = group.first; d <= group.second; ++d)
+            dims[i] *= squeezed[d];
+        perm[order[i]] = i;
     }
-    return pos;
 }
 
-class NaiveTranspose : public CpuKernelWithoutConfig {
+// 把 src 中 rows x cols 的块转置写入 dst：dst[j * ldd + i] = src[i * lds + j]
+template <typename T>
+static void transposeTileScalar(const T *src, size_t lds, T *dst, size_t ldd, size_t rows, size_t cols) {
+    // 按 8x8 的小块访问，使读写两侧都能保持在少量缓存行内
+    for (size_t i0 = 0; i0 < rows; i0 += 8)
+        for (size_t j0 = 0; j0 < cols; j0 += 8) {
+            size_t i1 = std::min(rows, i0 + 8), j1 = std::min(cols, j0 + 8);
+            for (size_t j = j0; j < j1; ++j)
+                for (size_t i = i0; i < i1; ++i)
+                    dst[j * ldd + i] = src[i * lds + j];
+        }
+}
+
+#if defined(__x86_64__)
+// 4 字节元素的 8x8 块在寄存器中完成转置：unpack 交错相邻两行，shuffle 组合 4 行，permute2f128 交换 128 位的半边
+__attribute__((target("avx"))) static void transposeTileAvx(const uint32_t *src, size_t lds, uint32_t *dst,
+                                                            size_t ldd, size_t rows, size_t cols) {
+    const size_t rows8 = rows / 8 * 8, cols8 = cols / 8 * 8;
+    for (size_t i0 = 0; i0 < rows8; i0 += 8)
+        for (size_t j0 = 0; j0 < cols8; j0 += 8) {
+            const float *s = reinterpret_cast<const float *>(src + i0 * lds + j0);
+            __m256 r[8], t[8];
+#pragma GCC unroll 8
+            for (int i = 0; i < 8; ++i)
+                r[i] = _mm256_loadu_ps(s + i * lds);
+#pragma GCC unroll 4
+            for (int i = 0; i < 4; ++i) {
+                t[2 * i] = _mm256_unpacklo_ps(r[2 * i], r[2 * i + 1]);
+                t[2 * i + 1] = _mm256_unpackhi_ps(r[2 * i], r[2 * i + 1]);
+            }
+#pragma GCC unroll 2
+            for (int h = 0; h < 2; ++h) {
+                __m256 *u = t + h * 4;
+                __m256 *v = r + h * 4;
+                v[0] = _mm256_shuffle_ps(u[0], u[2], _MM_SHUFFLE(1, 0, 1, 0));
+                v[1] = _mm256_shuffle_ps(u[0], u[2], _MM_SHUFFLE(3, 2, 3, 2));
+                v[2] = _mm256_shuffle_ps(u[1], u[3], _MM_SHUFFLE(1, 0, 1, 0));
+                v[3] = _mm256_shuffle_ps(u[1], u[3], _MM_SHUFFLE(3, 2, 3, 2));
+            }
+            float *d = reinterpret_cast<float *>(dst + j0 * ldd + i0);
+#pragma GCC unroll 4
+            for (int i = 0; i < 4; ++i) {
+                _mm256_storeu_ps(d + i * ldd, _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+                _mm256_storeu_ps(d + (i + 4) * ldd, _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+            }
+        }
+    // 右侧和下方不足 8 的边界
+    if (cols8 < cols)
+        transposeTileScalar(src + cols8, lds, dst + cols8 * ldd, ldd, rows, cols - cols8);
+    if (rows8 < rows)
+        transposeTileScalar(src + rows8 * lds, lds, dst + rows8, ldd, rows - rows8, cols8);
+}
+#endif
+
+template <typename T>
+using TransposeTileFn = void (*)(const T *src, size_t lds, T *dst, size_t ldd, size_t rows, size_t cols);
+
+template <typename T>
+static TransposeTileFn<T> getTransposeTile() {
+#if defined(__x86_64__)
+    if constexpr (sizeof(T) == 4)
+        if (getCpuFeatures().avx)
+            return transposeTileAvx;
+#endif
+    return transposeTileScalar<T>;
+}
+
+/**
+ * @brief 与数据类型无关的转置方案：合并后的形状、跨度以及分块方式，编译执行计划时只计算一次
+ */
+struct TransposePlan {
+    vector<size_t> dims;                 // 合并后的输入形状
+    vector<int> perm;                    // 合并后的排列
+    vector<size_t> inStride, outStride;  // 输入各维的跨度，以及输入第 i 维在输出中的跨度
+    size_t size = 0;
+    // 最内层维度被移动时，在 (输出的最内层维度 a, 输入的最内层维度 c) 构成的平面上分块转置
+    int a = 0, c = 0;
+    vector<int> batchAxes;
+    size_t tilesR = 0, tilesC = 0, tasks = 0;
+
+    TransposePlan(vector<size_t> inDims, vector<int> permute) : dims(std::move(inDims)), perm(std::move(permute)) {
+        simplifyPermute(dims, perm);
+        const int rank = dims.size();
+        size = std::accumulate(dims.begin(), dims.end(), (size_t)1, std::multiplies<size_t>());
+        inStride.resize(rank);
+        outStride.resize(rank);
+        for (size_t i = rank, s = 1; i-- > 0;) {
+            inStride[i] = s;
+            s *= dims[i];
+        }
+        for (size_t j = rank, s = 1; j-- > 0;) {
+            outStride[perm[j]] = s;
+            s *= dims[perm[j]];
+        }
+        if (size == 0 || rank <= 1 || perm[rank - 1] == rank - 1)
+            return;
+        a = perm[rank - 1], c = rank - 1;
+        for (int i = 0; i < rank; ++i)
+            if (i != a && i != c)
+                batchAxes.push_back(i);
+        tilesR = (dims[a] + kTransposeTile - 1) / kTransposeTile;
+        tilesC = (dims[c] + kTransposeTile - 1) / kTransposeTile;
+        tasks = size / (dims[a] * dims[c]) * tilesR * tilesC;
+    }
+};
+
+/**
+ * @brief 转置的通用实现：T 只决定元素的字节数，因此所有数据类型共用 1、2、4、8 字节四种实例
+ */
+template <typename T>
+static void transpose(ThreadPool *pool, const T *in, T *out, const TransposePlan &plan) {
+    const auto &dims = plan.dims, &inStride = plan.inStride, &outStride = plan.outStride;
+    const auto &perm = plan.perm;
+    const int rank = dims.size();
+    const size_t size = plan.size;
+    if (size == 0)
+        return;
+    if (rank <= 1) {
+        std::memcpy(out, in, size * sizeof(T));
+        return;
+    }
+
+    // 较大的转置把任务均分给线程池中的线程，每个线程处理连续的一段任务
+    auto parallelRange = [&](size_t tasks, auto &&func) {
+        const size_t chunks =
+            size >= kTransposeTile * kTransposeTile ? std::min<size_t>(getNumThreads(pool), tasks) : 1;
+        parallelFor(pool, chunks, [&](size_t chunk) {
+            for (size_t t = tasks * chunk / chunks; t < tasks * (chunk + 1) / chunks; ++t)
+                func(t);
+        });
+    };
+
+    if (perm[rank - 1] == rank - 1) {
+        // 最内层维度没有移动：按输出的顺序逐行拷贝连续的一段
+        const size_t row = dims[rank - 1], rows = size / row;
+        parallelRange(rows, [&](size_t r) {
+            size_t rest = r, inOffset = 0;
+            for (int j = rank - 2; j >= 0; --j) {
+                inOffset += rest % dims[perm[j]] * inStride[perm[j]];
+                rest /= dims[perm[j]];
+            }
+            std::memcpy(out + r * row, in + inOffset, row * sizeof(T));
+        });
+        return;
+    }
+
+    // 最内层维度被移动：在 (a, c) 平面上分块转置，其余维度作为 batch
+    const int a = plan.a, c = plan.c;
+    const size_t rowsA = dims[a], colsC = dims[c];
+    const size_t lds = inStride[a], ldd = outStride[c];
+    const auto &batchAxes = plan.batchAxes;
+    const size_t tilesR = plan.tilesR, tilesC = plan.tilesC, tasks = plan.tasks;
+    static const auto tile = getTransposeTile<T>();
+
+    parallelRange(tasks, [&](size_t t) {
+        size_t tc = t % tilesC, tr = t / tilesC % tilesR, b = t / (tilesC * tilesR);
+        size_t inOffset = 0, outOffset = 0;
+        for (size_t k = batchAxes.size(); k-- > 0;) {
+            int axis = batchAxes[k];
+            size_t idx = b % dims[axis];
+            b /= dims[axis];
+            inOffset += idx * inStride[axis];
+            outOffset += idx * outStride[axis];
+        }
+        size_t i0 = tr * kTransposeTile, j0 = tc * kTransposeTile;
+        tile(in + inOffset + i0 * lds + j0, lds, out + outOffset + j0 * ldd + i0, ldd,
+             std::min(kTransposeTile, rowsA - i0), std::min(kTransposeTile, colsC - j0));
+    });
+}
+
+class NativeTranspose : public CpuKernelWithoutConfig {
     template <typename T>
-    void doCompute(const Operator &_op, const RuntimeObj *context) const {
+    static PreparedKernel prepare(TransposePlan plan, ThreadPool *pool) {
+        return [plan = std::move(plan), pool](void *const *inputs, void *const *outputs) {
+            transpose(pool, static_cast<const T *>(inputs[0]), static_cast<T *>(outputs[0]), plan);
+        };
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        computePrepared(_op, context);
+    }
+
+    PreparedKernel prepare(const Operator &_op,
+                           const RuntimeObj *context) const override {
         auto op = as<TransposeObj>(_op);
-        auto inputs = op->getInputs(), outputs = op->getOutputs();
-        const auto &inDim = inputs[0]->getDims();
-        const auto &perm = op->getPermute();
-
-        size_t inSize = inputs[0]->size();
-        auto inPtr = inputs[0]->getRawDataPtr<T *>(),
-             outPtr = outputs[0]->getRawDataPtr<T *>();
-        // #pragma omp parallel for
-        for (size_t inIdx = 0; inIdx < inSize; ++inIdx) {
-            auto posInput = idx2Pos(inDim, inIdx);
-            int outIdx = 0;
-            for (size_t j = 0, jEnd = perm.size(); j < jEnd; ++j) {
-                outIdx = outIdx * inDim[perm[j]] + posInput[perm[j]];
-            }
-            outPtr[outIdx] = inPtr[inIdx];
+        const auto &inDim = op->getInputs(0)->getDims();
+        TransposePlan plan(vector<size_t>(inDim.begin(), inDim.end()), op->getPermute());
+        // 转置只搬运数据，按元素的字节数选择实例
+        switch (_op->getDType().getSize()) {
+        case 1:
+            return prepare<uint8_t>(std::move(plan), context->getThreadPool());
+        case 2:
+            return prepare<uint16_t>(std::move(plan), context->getThreadPool());
+        case 4:
+            return prepare<uint32_t>(std::move(plan), context->getThreadPool());
+        case 8:
+            return prepare<uint64_t>(std::move(plan), context->getThreadPool());
+        default:
+            IT_TODO_HALT();
         }
     }
+};
+
+/**
+ * @brief 逐元素的转置：按输出顺序遍历，用计数器递推输入偏移量，不分块也不并行。
+ * 极小的张量上没有分块和任务划分的开销，作为自动调优的候选
+ */
+class NaiveTranspose : public CpuKernelWithoutConfig {
+    template <typename T>
+    static PreparedKernel prepare(TransposePlan plan) {
+        return [plan = std::move(plan)](void *const *inputs, void *const *outputs) {
+            const T *in = static_cast<const T *>(inputs[0]);
+            T *out = static_cast<T *>(outputs[0]);
+            const int rank = plan.dims.size();
+            vector<size_t> index(rank, 0);
+            size_t inOffset = 0;
+            for (size_t o = 0; o < plan.size; ++o) {
+                out[o] = in[inOffset];
+                // 输出的第 j 维对应输入的第 perm[j] 维，从最内层开始进位
+                for (int j = rank - 1; j >= 0; --j) {
+                    const int axis = plan.perm[j];
+                    inOffset += plan.inStride[axis];
+                    if (++index[j] < plan.dims[axis])
+                        break;
+                    inOffset -= plan.inStride[axis] * plan.dims[axis];
+                    index[j] = 0;
+                }
+            }
+        };
+    }
 
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
-#define CASE(N)                                                                \
-    case N:                                                                    \
-        doCompute<DT<N>::t>(_op, context)
-
-        int dataTypeIdx = _op->getDType().getIndex();
-        switch (dataTypeIdx) {
-            CASE(1); // DataType::Float32
-            break;
-            CASE(12); // DataType::UInt32
-            break;
+        computePrepared(_op, context);
+    }
+
+    PreparedKernel prepare(const Operator &_op,
+                           const RuntimeObj *context) const override {
+        auto op = as<TransposeObj>(_op);
+        const auto &inDim = op->getInputs(0)->getDims();
+        TransposePlan plan(vector<size_t>(inDim.begin(), inDim.end()), op->getPermute());
+        switch (_op->getDType().getSize()) {
+        case 1:
+            return prepare<uint8_t>(std::move(plan));
+        case 2:
+            return prepare<uint16_t>(std::move(plan));
+        case 4:
+            return prepare<uint32_t>(std::move(plan));
+        case 8:
+            return prepare<uint64_t>(std::move(plan));
         default:
             IT_TODO_HALT();
         }
     }
 };
 
+REGISTER_KERNEL(Device::CPU, OpType::Transpose, NativeTranspose,
+                "TransposeTiled_CPU");
 REGISTER_KERNEL(Device::CPU, OpType::Transpose, NaiveTranspose,
                 "TransposeNaive_CPU");
 
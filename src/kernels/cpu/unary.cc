@@ -1,105 +1,103 @@
 #include "operators/unary.h"
 #include "core/kernel.h"
+#include "kernels/cpu/element_wise.h"
+
+#include <cmath>
+#include <limits>
 
 namespace infini
 {
+    template <int DType>
     class NativeUnary : public CpuKernelWithoutConfig
     {
-        template <typename T>
-        static T reluCompute(T val)
+        using T = typename DT<DType>::t;
+
+        struct ReluOp
+        {
+            T operator()(T val) const { return val > T(0) ? val : T(0); }
+        };
+
+        template <typename Op>
+        static PreparedKernel prepareUnary(size_t n, ThreadPool *pool)
         {
-            return std::max(T(0), val);
+            return [n, pool](void *const *inputs, void *const *outputs)
+            {
+                elementWiseUnary<T>(pool, Op(), static_cast<const T *>(inputs[0]), static_cast<T *>(outputs[0]), n);
+            };
         }
 
-        template <typename T>
-        void doCompute(const Operator &_op, const RuntimeObj *context) const
+        PreparedKernel prepare(const Operator &_op,
+                               const RuntimeObj *context) const override
         {
             auto op = as<UnaryObj>(_op);
-            T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
-            T *outptr = op->getOutput()->getRawDataPtr<T *>();
-
-            auto outDim = op->getOutput()->getDims();
             auto n = op->getOutput()->size();
-
-            T (*_doCompute)
-            (T val);
             switch (op->getOpType().underlying())
             {
             case OpType::Relu:
-                _doCompute = reluCompute<T>;
-                break;
+                return prepareUnary<ReluOp>(n, context->getThreadPool());
             default:
                 IT_TODO_HALT();
             }
-
-            for (size_t offset = 0; offset < n; offset++)
-            {
-                outptr[offset] = _doCompute(inptr[offset]);
-            }
         }
 
         void compute(const Operator &_op,
                      const RuntimeObj *context) const override
         {
-#define CASE(N) \
-    case N:     \
-        doCompute<DT<N>::t>(_op, context)
-
-            int dataTypeIdx = _op->getDType().getIndex();
-            switch (dataTypeIdx)
-            {
-                CASE(1); // DataType::Float32
-                break;
-                CASE(12); // DataType::UInt32
-                break;
-            default:
-                IT_TODO_HALT();
-            }
+            computePrepared(_op, context);
         }
     };
 
+    template <int DType>
     class Clip : public CpuKernelWithoutConfig
     {
-        template <typename T>
-        void doCompute(const Operator &_op, const RuntimeObj *context) const
+        using T = typename DT<DType>::t;
+
+        // 没有给出的上下界（或为 NaN）取该类型的极值，给出的上下界先饱和到该类型的表示范围内
+        struct ClipOp
         {
-            auto op = as<ClipObj>(_op);
-            T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
-            T *outptr = op->getOutput()->getRawDataPtr<T *>();
-            auto minValue = op->getMin();
-            auto maxValue = op->getMax();
+            T minValue, maxValue;
+            T operator()(T val) const
+            {
+                val = val < minValue ? minValue : val;
+                return val > maxValue ? maxValue : val;
+            }
+        };
 
+        static T toBound(std::optional<float> value, T absent)
+        {
+            if (!value || std::isnan(*value))
+                return absent;
+            // int64/uint64 的最大值转换为 double 后向上舍入（2^63、2^64），因此用 >= 比较，避免超出范围的转换
+            const double v = *value;
+            if (v >= (double)std::numeric_limits<T>::max())
+                return std::numeric_limits<T>::max();
+            if (v <= (double)std::numeric_limits<T>::lowest())
+                return std::numeric_limits<T>::lowest();
+            return (T)v;
+        }
+
+        PreparedKernel prepare(const Operator &_op,
+                               const RuntimeObj *context) const override
+        {
+            auto op = as<ClipObj>(_op);
+            ClipOp clip{toBound(op->getMin(), std::numeric_limits<T>::lowest()),
+                        toBound(op->getMax(), std::numeric_limits<T>::max())};
             auto n = op->getOutput()->size();
-            for (size_t offset = 0; offset < n; offset++)
+            ThreadPool *pool = context->getThreadPool();
+            return [clip, n, pool](void *const *inputs, void *const *outputs)
             {
-                auto val = *inptr++;
-                *outptr++ = (minValue && val < *minValue)   ? *minValue
-                            : (maxValue && val > *maxValue) ? *maxValue
-                                                            : val;
-            }
+                elementWiseUnary<T>(pool, clip, static_cast<const T *>(inputs[0]), static_cast<T *>(outputs[0]), n);
+            };
         }
 
         void compute(const Operator &_op,
                      const RuntimeObj *context) const override
         {
-#define CASE(N) \
-    case N:     \
-        doCompute<DT<N>::t>(_op, context)
-
-            int dataTypeIdx = _op->getDType().getIndex();
-            switch (dataTypeIdx)
-            {
-                CASE(1); // DataType::Float32
-                break;
-                CASE(12); // DataType::UInt32
-                break;
-            default:
-                IT_TODO_HALT();
-            }
+            computePrepared(_op, context);
         }
     };
 
-    REGISTER_KERNEL(Device::CPU, OpType::Relu, NativeUnary, "reluNaive_CPU");
-    REGISTER_KERNEL(Device::CPU, OpType::Clip, Clip, "Clip_CPU");
+    REGISTER_KERNEL_TYPES(Device::CPU, OpType::Relu, NativeUnary, "reluNaive_CPU", ELEMENT_WISE_DTYPES);
+    REGISTER_KERNEL_TYPES(Device::CPU, OpType::Clip, Clip, "Clip_CPU", ELEMENT_WISE_DTYPES);
 
 }; // namespace infini
@@ -17,6 +17,16 @@ namespace infini
         return {{res}};
     }
 
+    vector<int> ElementWiseObj::getInplaceInputs() const
+    {
+        vector<int> ret;
+        for (int i = 0; i < numInputs(); ++i)
+            if (inputs[i]->getDims() == outputs[0]->getDims() &&
+                inputs[i]->getDType() == outputs[0]->getDType())
+                ret.push_back(i);
+        return ret;
+    }
+
     std::string ElementWiseObj::toString() const
     {
         std::ostringstream os;
@@ -1,5 +1,7 @@
 #include "operators/matmul.h"
 
+#include "utils/operator_utils.h"
+
 namespace infini {
 
 MatmulObj::MatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C, bool transA, bool transB)
@@ -7,6 +9,9 @@ MatmulObj::MatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C, bool transA,
   IT_ASSERT(checkValid(graph));
 }
 
+MatmulObj::MatmulObj(OpType type, GraphObj *graph, TensorVec inputs, Tensor C, bool transA, bool transB)
+    : OperatorObj(type, inputs, {C}), transA(transA), transB(transB) {}
+
 string MatmulObj::toString() const {
   std::ostringstream os;
   os << "Matmul([" << (transA ? "A^T" : "A") << "," << (transB ? "B^T" : "B]") << ",A=" << inputs[0]->getGuid()
@@ -24,13 +29,15 @@ optional<vector<Shape>> MatmulObj::inferShape(const TensorVec &inputs) {
   // 分别保存第一个和第二个输入矩阵的宽高
   int m1, n1, m2, n2;
 
-  // 获取输入张量的维度
-  int inputsShapeDim = inputs[0]->getDims().size();
+  // 获取输入张量的形状，两个输入的秩可以不同
+  const auto shapeA = inputs[0]->getDims(), shapeB = inputs[1]->getDims();
+  int rankA = shapeA.size(), rankB = shapeB.size();
+  IT_ASSERT(rankA >= 2 && rankB >= 2);
   // 获取最后两个维度作为矩阵的宽高
-  m1 = inputs[0]->getDims()[inputsShapeDim - 2];
-  n1 = inputs[0]->getDims()[inputsShapeDim - 1];
-  m2 = inputs[1]->getDims()[inputsShapeDim - 2];
-  n2 = inputs[1]->getDims()[inputsShapeDim - 1];
+  m1 = shapeA[rankA - 2];
+  n1 = shapeA[rankA - 1];
+  m2 = shapeB[rankB - 2];
+  n2 = shapeB[rankB - 1];
 
   // 如果进行转置，需要交换宽高
   if (transA) {
@@ -43,15 +50,51 @@ optional<vector<Shape>> MatmulObj::inferShape(const TensorVec &inputs) {
   // 第一个矩阵的高要等于第二个的宽
   IT_ASSERT(n1 == m2);
 
-  // 最后两个之前的维度，取两个矩阵的最大值
-  Shape ans = inputs[0]->getDims();
-  for (int i = 0; i < inputsShapeDim - 2; i++) {
-    ans[i] = std::max(ans[i], inputs[1]->getDims()[i]);
-  }
-  ans[ans.size() - 2] = m1;
-  ans[ans.size() - 1] = n2;
+  // 记录矩阵乘的 m、n、k，供 kernel 直接使用
+  m = m1;
+  n = n2;
+  k = n1;
+
+  // 最后两个之前的维度按照 NumPy 的规则进行双向广播
+  Shape ans = infer_broadcast(Shape(shapeA.begin(), shapeA.end() - 2), Shape(shapeB.begin(), shapeB.end() - 2));
+  ans.push_back(m1);
+  ans.push_back(n2);
 
   return {{ans}};
 }
 
-}  // namespace infini
\ No newline at end of file
+QuantizedMatmulObj::QuantizedMatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C, float scaleA,
+                                       int32_t zeroPointA, vector<float> scaleB, vector<int32_t> zeroPointB,
+                                       bool transA, bool transB)
+    : MatmulObj(OpType::QuantizedMatMul, graph, {A, B}, C, transA, transB),
+      scaleA(scaleA),
+      zeroPointA(zeroPointA),
+      scaleB(std::move(scaleB)),
+      zeroPointB(std::move(zeroPointB)) {
+  IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>> QuantizedMatmulObj::inferShape(const TensorVec &inputs) {
+  auto dtypeA = inputs[0]->getDType(), dtypeB = inputs[1]->getDType();
+  IT_ASSERT(dtypeA == DataType::Int8 || dtypeA == DataType::UInt8);
+  IT_ASSERT(dtypeB == DataType::Int8);
+  auto ans = MatmulObj::inferShape(inputs);
+  // B 的量化参数要么按张量只有一个，要么每个输出通道一个
+  IT_ASSERT(scaleB.size() == zeroPointB.size());
+  IT_ASSERT(scaleB.size() == 1 || (int)scaleB.size() == getN());
+  return ans;
+}
+
+vector<DataType> QuantizedMatmulObj::inferDataType(const TensorVec &inputs) const { return {DataType::Float32}; }
+
+string QuantizedMatmulObj::toString() const {
+  std::ostringstream os;
+  os << "QuantizedMatmul([" << (getTransA() ? "A^T" : "A") << "," << (getTransB() ? "B^T" : "B") << "]"
+     << ",A=" << inputs[0]->getGuid() << ",B=" << inputs[1]->getGuid() << ",C=" << outputs[0]->getGuid()
+     << ",mnk=[" << getM() << "," << getN() << "," << getK() << "]"
+     << ",scaleA=" << scaleA << ",zeroPointA=" << zeroPointA << (isPerChannel() ? ",perChannel" : ",perTensor")
+     << ")";
+  return os.str();
+}
+
+}  // namespace infini
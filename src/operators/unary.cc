@@ -75,6 +75,11 @@ std::string CastObj::toString() const {
   return os.str();
 }
 
+vector<int> CastObj::getInplaceInputs() const {
+  if (inputs[0]->getDType().getSize() == getOutputDataType().getSize()) return {0};
+  return {};
+}
+
 DataType CastObj::getOutputDataType() const {
   switch (castType) {
     case CastType::Float2Float16:
@@ -0,0 +1,100 @@
+#include "utils/cpu_info.h"
+
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace infini {
+
+#if defined(__x86_64__) || defined(__i386__)
+static CpuFeatures detectCpuFeatures() {
+  CpuFeatures features;
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return features;
+
+  features.sse41 = ecx & bit_SSE4_1;
+  features.fma = ecx & bit_FMA;
+  features.f16c = ecx & bit_F16C;
+  bool osxsave = ecx & bit_OSXSAVE;
+  bool avx = ecx & bit_AVX;
+
+  // 只有操作系统开启了 XSAVE 并且会保存 YMM/ZMM 状态时，才能使用 AVX/AVX-512
+  unsigned long long xcr0 = 0;
+  if (osxsave) {
+    unsigned int lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    xcr0 = ((unsigned long long)hi << 32) | lo;
+  }
+  bool ymmState = (xcr0 & 0x6) == 0x6;
+  bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+  features.avx = avx && ymmState;
+  features.fma = features.fma && features.avx;
+  features.f16c = features.f16c && features.avx;
+
+  if (__get_cpuid_max(0, nullptr) >= 7) {
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    features.avx2 = features.avx && (ebx & bit_AVX2);
+    features.avx512f = zmmState && (ebx & bit_AVX512F);
+    features.avx512bw = features.avx512f && (ebx & bit_AVX512BW);
+    features.avx512vl = features.avx512f && (ebx & bit_AVX512VL);
+    features.avx512vnni = features.avx512f && (ecx & bit_AVX512VNNI);
+    __cpuid_count(7, 1, eax, ebx, ecx, edx);
+    features.avx512bf16 = features.avx512f && (eax & bit_AVX512BF16);
+  }
+  return features;
+}
+#else
+static CpuFeatures detectCpuFeatures() { return CpuFeatures(); }
+#endif
+
+const CpuFeatures &getCpuFeatures() {
+  static const CpuFeatures features = detectCpuFeatures();
+  return features;
+}
+
+size_t getLastLevelCacheSize() {
+  static const size_t size = [] {
+    long bytes = -1;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+    bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (bytes <= 0) bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    return bytes > 0 ? (size_t)bytes : (size_t)8 << 20;
+  }();
+  return size;
+}
+
+const std::string &getCpuSignature() {
+  static const std::string signature = [] {
+    std::string model = "unknown";
+#if defined(__x86_64__) || defined(__i386__)
+    // 处理器型号保存在扩展 CPUID 0x80000002 ~ 0x80000004 中，共 48 个字符
+    if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004) {
+      unsigned int brand[12];
+      for (unsigned int i = 0; i < 3; ++i)
+        __get_cpuid(0x80000002 + i, &brand[4 * i], &brand[4 * i + 1], &brand[4 * i + 2], &brand[4 * i + 3]);
+      model.assign(reinterpret_cast<const char *>(brand), sizeof(brand));
+      model = model.substr(0, model.find('\0'));
+      model.erase(0, model.find_first_not_of(' '));
+    }
+#endif
+    const CpuFeatures &f = getCpuFeatures();
+    std::string signature = model + ";isa=";
+    const std::pair<bool, const char *> isa[] = {
+        {f.sse41, "sse4.1"},         {f.avx, "avx"},         {f.avx2, "avx2"},
+        {f.fma, "fma"},              {f.f16c, "f16c"},       {f.avx512f, "avx512f"},
+        {f.avx512bw, "avx512bw"},    {f.avx512vl, "avx512vl"}, {f.avx512vnni, "avx512vnni"},
+        {f.avx512bf16, "avx512bf16"}};
+    for (auto &[supported, name] : isa)
+      if (supported) signature += std::string(name) + ",";
+    for (char &c : signature)
+      if (c == '\t' || c == '\n') c = ' ';
+    return signature;
+  }();
+  return signature;
+}
+
+}  // namespace infini
@@ -0,0 +1,98 @@
+#include "utils/mmap_arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace infini {
+
+size_t getHugePageSize() {
+  static const size_t size = [] {
+    std::ifstream meminfo("/proc/meminfo");
+    std::string key;
+    size_t value;
+    while (meminfo >> key >> value) {
+      if (key == "Hugepagesize:") return value * 1024;  // 单位为 kB
+      meminfo.ignore(256, '\n');
+    }
+    return size_t(1) << 21;
+  }();
+  return size;
+}
+
+bool transparentHugePagesEnabled() {
+  static const bool enabled = [] {
+    // 内容形如 "always [madvise] never"，方括号中是当前的设置
+    std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string mode;
+    while (file >> mode)
+      if (mode == "[always]" || mode == "[madvise]") return true;
+    return false;
+  }();
+  return enabled;
+}
+
+#if defined(__linux__)
+static size_t roundUp(size_t size, size_t alignment) { return (size + alignment - 1) / alignment * alignment; }
+
+// 不依赖 libnuma，直接调用 mbind 系统调用；MPOL_BIND = 2
+static bool bindToNode(void *ptr, size_t length, int node) {
+  constexpr int mpolBind = 2;
+  constexpr size_t bitsPerWord = sizeof(unsigned long) * 8;
+  unsigned long mask[16] = {};
+  if (node < 0 || size_t(node) >= sizeof(mask) * 8) return false;
+  mask[node / bitsPerWord] = 1UL << (node % bitsPerWord);
+  return syscall(SYS_mbind, ptr, length, mpolBind, mask, sizeof(mask) * 8, 0) == 0;
+}
+
+MmapRegion mmapArena(size_t size, size_t alignment, const MmapArenaConfig &config) {
+  MmapRegion region;
+  const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  const size_t hugePageSize = getHugePageSize();
+  size = std::max<size_t>(size, 1);
+
+  if (config.hugePages == HugePageMode::Explicit && alignment <= hugePageSize) {
+    size_t length = roundUp(size, hugePageSize);
+    void *ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) region = {ptr, length, true, false};
+  }
+
+  if (!region.ptr) {
+    // 多映射一段再截掉首尾，使起始地址按大页（或要求的对齐）对齐，透明大页才能覆盖整个区域
+    const size_t align = std::max({alignment, pageSize, config.hugePages == HugePageMode::None ? 0 : hugePageSize});
+    const size_t length = roundUp(size, config.hugePages == HugePageMode::None ? pageSize : hugePageSize);
+    const size_t mapped = length + align;
+    void *ptr = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr == MAP_FAILED) return {};
+    auto begin = reinterpret_cast<uintptr_t>(ptr), aligned = roundUp(begin, align);
+    if (aligned > begin) munmap(ptr, aligned - begin);
+    if (begin + mapped > aligned + length) munmap(reinterpret_cast<void *>(aligned + length), begin + mapped - aligned - length);
+    region = {reinterpret_cast<void *>(aligned), length, false, false};
+#if defined(MADV_HUGEPAGE)
+    if (config.hugePages != HugePageMode::None)
+      region.hugePages = madvise(region.ptr, length, MADV_HUGEPAGE) == 0 && transparentHugePagesEnabled();
+#endif
+  }
+
+  // 页面还没有分配，绑定后第一次写入时就分配在该节点上
+  if (config.numaNode >= 0) region.numaBound = bindToNode(region.ptr, region.length, config.numaNode);
+  return region;
+}
+
+void munmapArena(const MmapRegion &region) {
+  if (region.ptr) munmap(region.ptr, region.length);
+}
+#else
+MmapRegion mmapArena(size_t, size_t, const MmapArenaConfig &) { return {}; }
+
+void munmapArena(const MmapRegion &) {}
+#endif
+
+}  // namespace infini
@@ -23,11 +23,9 @@ Shape infer_broadcast(const Shape &A, const Shape &B) {
   // 以较大的 rank 作为结果的 rank
   Shape ans(rank1, 1);
 
-  if (rank1 != rank2) {
-    // B 的尺寸比 A 小，将 B 后面的尺寸复制到 ans 中
-    for (size_t i = 0; i < rank2; ++i) {
-      ans[rank1 - rank2 + i] = B[i];
-    }
+  // 将 B 的尺寸右对齐复制到 ans 中（B 的秩小于等于 A 的秩）
+  for (size_t i = 0; i < rank2; ++i) {
+    ans[rank1 - rank2 + i] = B[i];
   }
 
   // 从前向后遍历 A 和 ans 的尺寸，选择最大的尺寸作为结果的尺寸
@@ -96,7 +94,9 @@ std::string device_to_str(Device device) {
 std::string get_kernel_attrs_str(const KernelAttrs &kernelAttrs) {
   std::string deviceStr = device_to_str(std::get<0>(kernelAttrs));
   std::string opStr = OpType(std::get<1>(kernelAttrs)).toString();
-  return deviceStr + ", " + opStr;
+  int dtype = std::get<2>(kernelAttrs);
+  std::string dtypeStr = dtype < 0 ? "Any" : DataType(dtype).toString();
+  return deviceStr + ", " + opStr + ", " + dtypeStr;
 }
 
 }  // namespace infini
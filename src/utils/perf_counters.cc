@@ -0,0 +1,106 @@
+#include "utils/perf_counters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace infini {
+
+#if defined(__linux__)
+static int openEvent(PerfEvent event, int groupFd) {
+  static const uint64_t configs[kNumPerfEvents] = {
+      PERF_COUNT_HW_CPU_CYCLES,       PERF_COUNT_HW_INSTRUCTIONS,        PERF_COUNT_HW_CACHE_REFERENCES,
+      PERF_COUNT_HW_CACHE_MISSES,     PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+  };
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = configs[static_cast<size_t>(event)];
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // 只统计用户态，perf_event_paranoid 为 2 时普通用户也可以打开
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+#endif
+
+PerfCounters::PerfCounters() {
+#if defined(__linux__)
+  // 第一个打开成功的事件作为组长，其余事件加入它的组；组内放不下的事件打开失败，直接跳过
+  for (size_t i = 0; i < kNumPerfEvents; ++i) {
+    int fd = openEvent(static_cast<PerfEvent>(i), fds.empty() ? -1 : fds[0]);
+    if (fd < 0) continue;
+    fds.push_back(fd);
+    events.push_back(static_cast<PerfEvent>(i));
+  }
+  available = !fds.empty();
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+  // 先关闭组员，最后关闭组长
+  for (auto it = fds.rbegin(); it != fds.rend(); ++it) close(*it);
+#endif
+}
+
+PerfCounters &PerfCounters::forCurrentThread() {
+  thread_local PerfCounters counters;
+  return counters;
+}
+
+PerfCounterValues PerfCounters::read() const {
+  PerfCounterValues ret;
+#if defined(__linux__)
+  if (fds.empty()) return ret;
+  // 读取组长得到整组的计数：nr, time_enabled, time_running, value[nr]
+  uint64_t data[3 + kNumPerfEvents];
+  const ssize_t size = (3 + fds.size()) * sizeof(uint64_t);
+  if (::read(fds[0], data, size) != size || data[0] != fds.size() || data[2] == 0) return ret;
+  // 整组分时复用时按实际计数的时间比例估计全部时间内的计数
+  const double scale = data[2] < data[1] ? double(data[1]) / double(data[2]) : 1.0;
+  for (size_t i = 0; i < fds.size(); ++i)
+    ret.values[static_cast<size_t>(events[i])] = scale == 1.0 ? data[3 + i] : uint64_t(double(data[3 + i]) * scale);
+#endif
+  return ret;
+}
+
+void PerfCounterScope::start() {
+  total = PerfCounterValues();
+  started = PerfCounters::forCurrentThread().now();
+  previous = setTaskObserver(this);
+}
+
+PerfCounterValues PerfCounterScope::stop() {
+  setTaskObserver(previous);
+  auto delta = PerfCounters::forCurrentThread().now() - started;
+  std::lock_guard<std::mutex> lock(mutex);
+  total += delta;
+  return total;
+}
+
+// 同一个线程不会嵌套执行同一个观察者的任务，每个线程记录一个起点即可
+static thread_local PerfCounterValues taskStarted;
+
+void PerfCounterScope::begin() { taskStarted = PerfCounters::forCurrentThread().now(); }
+
+void PerfCounterScope::end() {
+  auto delta = PerfCounters::forCurrentThread().now() - taskStarted;
+  std::lock_guard<std::mutex> lock(mutex);
+  total += delta;
+}
+
+PerfCounterValues operator-(const PerfCounterValues &after, const PerfCounterValues &before) {
+  PerfCounterValues ret;
+  for (size_t i = 0; i < kNumPerfEvents; ++i)
+    ret.values[i] = after.values[i] > before.values[i] ? after.values[i] - before.values[i] : 0;
+  return ret;
+}
+
+}  // namespace infini
@@ -0,0 +1,222 @@
+#include "utils/thread_pool.h"
+
+#include <chrono>
+#include <exception>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace infini {
+
+// 当前线程所属的线程池及其编号，不是工作线程时 pool 为空
+static thread_local const ThreadPool *currentPool = nullptr;
+static thread_local int currentIndex = -1;
+static thread_local TaskObserver *currentObserver = nullptr;
+
+TaskObserver *setTaskObserver(TaskObserver *observer) {
+  TaskObserver *previous = currentObserver;
+  currentObserver = observer;
+  return previous;
+}
+
+TaskObserver *getTaskObserver() { return currentObserver; }
+
+static inline void cpuRelax() {
+#if defined(__x86_64__)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+// 进程亲和性掩码中的 CPU 编号
+static std::vector<int> getAvailableCpus() {
+  std::vector<int> cpus;
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+      if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+#endif
+  if (cpus.empty())
+    for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) cpus.push_back(cpu);
+  return cpus;
+}
+
+int getAvailableCpuCount() {
+  static const int count = getAvailableCpus().size();
+  return count;
+}
+
+ThreadPool::ThreadPool(const ThreadPoolConfig &config) : config(config) { start(); }
+
+ThreadPool::~ThreadPool() { stop(); }
+
+void ThreadPool::configure(const ThreadPoolConfig &newConfig) {
+  stop();
+  config = newConfig;
+  start();
+}
+
+void ThreadPool::start() {
+  numThreads = config.threads > 0 ? config.threads : getAvailableCpuCount();
+  // 调用 parallelFor 的线程也参与计算，因此工作线程比线程总数少一个；
+  // 但至少保留一个工作线程执行 submit 提交的任务
+  const int n = std::max(1, numThreads - 1);
+  const auto cpus = getAvailableCpus();
+  stopping = false;
+  for (int i = 0; i < n; ++i) queues.emplace_back(std::make_unique<Queue>());
+  for (int i = 0; i < n; ++i) {
+    workers.emplace_back([this, i] {
+      currentPool = this;
+      currentIndex = i;
+      workerLoop(i);
+    });
+#if defined(__linux__)
+    // 第一个 CPU 留给调用线程，工作线程依次绑定到其余的 CPU 上
+    if (config.pinThreads) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpus[(i + 1) % cpus.size()], &set);
+      pthread_setaffinity_np(workers.back().native_handle(), sizeof(set), &set);
+    }
+#endif
+  }
+}
+
+void ThreadPool::stop() {
+  {
+    std::lock_guard<std::mutex> lock(sleepMutex);
+    stopping = true;
+  }
+  wakeup.notify_all();
+  for (auto &worker : workers) worker.join();
+  workers.clear();
+  queues.clear();
+}
+
+void ThreadPool::submit(Task task) {
+  const bool local = currentPool == this;
+  auto &queue = *queues[local ? currentIndex : nextQueue++ % queues.size()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  pending.fetch_add(1);
+  // 工作线程在休眠前先增加 sleeping 再检查 pending，因此这里看到 sleeping 为 0 时不会丢失唤醒
+  if (sleeping.load() > 0) {
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wakeup.notify_one();
+  }
+}
+
+bool ThreadPool::tryPop(int index, Task &task) {
+  // 先从自己队列的尾部取，再依次从其他队列的头部窃取
+  const int n = queues.size();
+  for (int k = 0; k < n; ++k) {
+    auto &queue = *queues[(index + k) % n];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) continue;
+    if (k == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    pending.fetch_sub(1);
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::workerLoop(int index) {
+  Task task;
+  const auto spin = std::chrono::microseconds(config.spinMicroseconds);
+  while (true) {
+    if (tryPop(index, task)) {
+      task();
+      task = nullptr;
+      continue;
+    }
+    // 先自旋等待新任务，避免频繁提交小任务时反复休眠、唤醒线程
+    if (spin.count() > 0) {
+      const auto deadline = std::chrono::steady_clock::now() + spin;
+      while (pending.load() == 0 && std::chrono::steady_clock::now() < deadline) cpuRelax();
+      if (pending.load() > 0) continue;
+    }
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    if (stopping && pending.load() == 0) return;
+    sleeping.fetch_add(1);
+    wakeup.wait(lock, [&] { return stopping || pending.load() > 0; });
+    sleeping.fetch_sub(1);
+  }
+}
+
+void ThreadPool::parallelFor(size_t tasks, const std::function<void(size_t)> &func) {
+  const size_t helpers = std::min<size_t>(tasks, numThreads) - 1;
+  if (tasks == 0) return;
+  if (helpers == 0) {
+    for (size_t t = 0; t < tasks; ++t) func(t);
+    return;
+  }
+
+  // 所有线程从 next 动态领取任务；帮忙的任务可能在 parallelFor 返回后才开始执行，
+  // 此时已经没有剩余任务，不会再访问 func，因此共享状态用 shared_ptr 保存
+  struct Job {
+    std::atomic<size_t> next{0}, finished{0};
+    size_t tasks;
+    const std::function<void(size_t)> *func;
+    TaskObserver *observer;
+    std::mutex mutex;
+    std::exception_ptr error;
+  };
+  auto job = std::make_shared<Job>();
+  job->tasks = tasks;
+  job->func = &func;
+  job->observer = getTaskObserver();
+  // 只有领取到任务的线程才通知观察者，并且在 end 之后才计入 finished，
+  // 保证 parallelFor 返回（观察者可能随之销毁）之后不会再访问它
+  auto work = [job](bool helper) {
+    size_t t = job->next.fetch_add(1);
+    if (t >= job->tasks) return;
+    TaskObserver *observer = helper ? job->observer : nullptr, *previous = nullptr;
+    if (observer) {
+      previous = setTaskObserver(observer);
+      observer->begin();
+    }
+    size_t done = 0;
+    for (; t < job->tasks; t = job->next.fetch_add(1), ++done) {
+      try {
+        (*job->func)(t);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        if (!job->error) job->error = std::current_exception();
+      }
+    }
+    if (observer) {
+      observer->end();
+      setTaskObserver(previous);
+    }
+    job->finished.fetch_add(done);
+  };
+  for (size_t i = 0; i < helpers; ++i) submit([work] { work(true); });
+  work(false);
+  // 剩下的只有其他线程已经领取、正在执行的任务
+  for (int spins = 0; job->finished.load() < tasks; ++spins) {
+    if (spins < 1024)
+      cpuRelax();
+    else
+      std::this_thread::yield();
+  }
+  if (job->error) std::rethrow_exception(job->error);
+}
+
+}  // namespace infini
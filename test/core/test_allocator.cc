@@ -1,3 +1,5 @@
+#include <cstdint>
+
 #include "core/graph.h"
 #include "core/kernel.h"
 #include "core/runtime.h"
@@ -109,4 +111,87 @@ TEST(Allocator, testGetPtr) {
   EXPECT_EQ(ptr1, ptr2);
 }
 
+TEST(Allocator, testAlignment) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  const size_t pageSize = RuntimeObj::getPageSize();
+  // 默认按缓存行对齐，偏移量和内存起始地址都是 64 的整数倍
+  EXPECT_EQ(runtime->getAlignment(), 64u);
+  Allocator allocator = Allocator(runtime);
+  EXPECT_EQ(allocator.getAlignedSize(12), 64u);
+  size_t offsetA = allocator.alloc(12);
+  size_t offsetB = allocator.alloc(100);
+  EXPECT_EQ(offsetA % 64, 0u);
+  EXPECT_EQ(offsetB % 64, 0u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(allocator.getPtr()) % 64, 0u);
+
+  // 较大的张量按页对齐，较小的张量按配置的对齐
+  runtime->setAlignment(128, 2 * pageSize);
+  Graph g = make_ref<GraphObj>(runtime);
+  auto x = g->addTensor({5}, DataType::Float32);
+  auto y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+  auto big = g->addTensor({int(pageSize)}, DataType::Float32);
+  auto z = g->addOp<ReluObj>(big, nullptr)->getOutput();
+  g->dataMalloc();
+  for (auto &t : {x, y})
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(t->getRawDataPtr<void *>()) % 128, 0u);
+  for (auto &t : {big, z})
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(t->getRawDataPtr<void *>()) % pageSize, 0u);
+  runtime->setAlignment(64);
+}
+
+TEST(Allocator, testMmapArena) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  const MmapArenaConfig original = runtime->getMmapArenaConfig();
+  const size_t hugePageSize = getHugePageSize(), size = hugePageSize + 12345;
+  // 没有预留大页时 Explicit 退回透明大页，总能得到可用的内存
+  for (auto mode : {HugePageMode::None, HugePageMode::Transparent, HugePageMode::Explicit}) {
+    MmapArenaConfig config;
+    config.enable = true;
+    config.hugePages = mode;
+    config.numaNode = 0;
+    runtime->setMmapArenaConfig(config);
+    auto ptr = static_cast<uint8_t *>(runtime->alloc(size));
+    const MmapRegion *region = runtime->getMmapRegion(ptr);
+    ASSERT_NE(region, nullptr);
+    EXPECT_GE(region->length, size);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % runtime->getBaseAlignment(), 0u);
+    if (mode != HugePageMode::None) {
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % hugePageSize, 0u);
+    }
+    // 透明大页设置为 never 时 madvise 仍然成功，但不能报告为使用了大页
+    if (mode == HugePageMode::Transparent) {
+      EXPECT_EQ(region->hugePages, transparentHugePagesEnabled());
+    } else if (mode == HugePageMode::None) {
+      EXPECT_FALSE(region->hugePages);
+    }
+    for (size_t i = 0; i < size; i += 4093) EXPECT_EQ(ptr[i], 0);
+    for (size_t i = 0; i < size; ++i) ptr[i] = uint8_t(i);
+    EXPECT_EQ(ptr[size - 1], uint8_t(size - 1));
+    runtime->dealloc(ptr);
+
+    // 小于 minSize 的分配仍然使用 aligned_alloc
+    void *small = runtime->alloc(64);
+    EXPECT_EQ(runtime->getMmapRegion(small), nullptr);
+    runtime->dealloc(small);
+  }
+
+  // 计算图的内存由 mmap 分配时结果不变
+  MmapArenaConfig config;
+  config.enable = true;
+  config.minSize = 0;
+  runtime->setMmapArenaConfig(config);
+  Graph g = make_ref<GraphObj>(runtime);
+  auto x = g->addTensor({1000}, DataType::Float32);
+  auto y = g->addOp<ReluObj>(x, nullptr)->getOutput();
+  g->dataMalloc();
+  EXPECT_NE(runtime->getMmapRegion(g->getDataArena().first), nullptr);
+  x->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i % 7) - 3.f;
+  });
+  runtime->run(g);
+  auto out = y->getRawDataPtr<float *>();
+  for (size_t i = 0; i < y->size(); ++i) EXPECT_EQ(out[i], std::max(float(i % 7) - 3.f, 0.f));
+  runtime->setMmapArenaConfig(original);
+}
+
 }  // namespace infini
@@ -0,0 +1,102 @@
+#include <future>
+#include <thread>
+
+#include "core/async_runner.h"
+#include "core/context.h"
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/unary.h"
+#include "test.h"
+
+namespace infini {
+
+TEST(ExecutionContext, ConcurrentRequests) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto x = g->addTensor({16, 32}, DataType::Float32);
+  auto w = g->addWeight({32, 24}, DataType::Float32);
+  auto bias = g->addWeight({24}, DataType::Float32);
+  auto matmul = g->addOp<MatmulObj>(x, w, nullptr);
+  auto add = g->addOp<AddObj>(matmul->getOutput(), bias, nullptr);
+  auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+  auto y = relu->getOutput();
+  g->dataMalloc();
+  w->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i % 7) - 3.f;
+  });
+  bias->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i % 5) - 2.f;
+  });
+  g->prepackWeights();
+  auto plan = runtime->compile(g);
+
+  auto setInput = [&](const ExecutionContext &context, int seed) {
+    context->setData(x, [&](void *ptr, size_t size, DataType) {
+      for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float((i * 3 + seed) % 11) - 5.f;
+    });
+  };
+  auto result = [&](const ExecutionContext &context) {
+    auto ptr = context->getRawDataPtr<float *>(y);
+    return vector<float>(ptr, ptr + y->size());
+  };
+
+  // 权重直接使用计算图中的数据，输入和中间结果在每个上下文自己的内存中
+  const int numContexts = 4, numRuns = 8;
+  vector<ExecutionContext> contexts;
+  for (int c = 0; c < numContexts; ++c) contexts.push_back(make_ref<ExecutionContextObj>(plan));
+  EXPECT_EQ(contexts[0]->getRawDataPtr<void *>(w), w->getRawDataPtr<void *>());
+  EXPECT_EQ(contexts[0]->getRawDataPtr<void *>(bias), contexts[1]->getRawDataPtr<void *>(bias));
+  EXPECT_NE(contexts[0]->getRawDataPtr<void *>(x), contexts[1]->getRawDataPtr<void *>(x));
+  EXPECT_NE(contexts[0]->getRawDataPtr<void *>(y), contexts[1]->getRawDataPtr<void *>(y));
+
+  vector<vector<float>> expected;
+  for (int seed = 0; seed < numContexts * numRuns; ++seed) {
+    setInput(contexts[0], seed);
+    runtime->run(contexts[0]);
+    expected.push_back(result(contexts[0]));
+  }
+
+  // 每个线程使用自己的上下文同时执行同一个计划
+  vector<std::thread> threads;
+  vector<int> mismatches(numContexts, 0);
+  for (int c = 0; c < numContexts; ++c)
+    threads.emplace_back([&, c] {
+      for (int r = 0; r < numRuns; ++r) {
+        int seed = r * numContexts + c;
+        setInput(contexts[c], seed);
+        runtime->run(contexts[c]);
+        if (result(contexts[c]) != expected[seed]) mismatches[c]++;
+      }
+    });
+  for (auto &thread : threads) thread.join();
+  for (int c = 0; c < numContexts; ++c) EXPECT_EQ(mismatches[c], 0);
+
+  // 异步提交：不同上下文的请求同时执行，不需要复制计算图和权重
+  auto oldConfig = runtime->getAsyncConfig();
+  runtime->setAsyncConfig({numContexts, 2 * numContexts});
+  vector<std::future<void>> pending(numContexts);
+  for (int r = 0; r < numRuns; ++r)
+    for (int c = 0; c < numContexts; ++c) {
+      int seed = r * numContexts + c;
+      if (pending[c].valid()) {
+        pending[c].get();
+        EXPECT_EQ(result(contexts[c]), expected[seed - numContexts]);
+      }
+      setInput(contexts[c], seed);
+      pending[c] = runtime->runAsync(contexts[c]);
+    }
+  for (int c = 0; c < numContexts; ++c) {
+    pending[c].get();
+    EXPECT_EQ(result(contexts[c]), expected[(numRuns - 1) * numContexts + c]);
+  }
+  std::promise<bool> done;
+  setInput(contexts[0], 0);
+  runtime->runAsync(contexts[0], [&](std::exception_ptr error) { done.set_value(!error); });
+  EXPECT_TRUE(done.get_future().get());
+  EXPECT_EQ(result(contexts[0]), expected[0]);
+  runtime->setAsyncConfig(oldConfig);
+}
+
+}  // namespace infini
@@ -1,8 +1,12 @@
 #include "core/graph.h"
 #include "core/kernel.h"
+#include "core/plan.h"
 #include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
 #include "operators/matmul.h"
 #include "operators/transpose.h"
+#include "operators/unary.h"
 #include "test.h"
 
 namespace infini {
@@ -45,4 +49,152 @@ TEST(Graph, Optimize) {
   EXPECT_EQ(op->getTransA(), false);
   EXPECT_EQ(op->getTransB(), true);
 }
-}  // namespace infini
\ No newline at end of file
+
+TEST(Graph, InplaceMalloc) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto i = g->addTensor({2, 3}, DataType::Float32);
+  auto b = g->addTensor({3}, DataType::Float32);
+  // relu 的输入是图的输入，不能原地计算
+  auto relu = g->addOp<ReluObj>(i, nullptr);
+  // t1 只被 clip 使用，clip 原地计算
+  auto clip = g->addOp<ClipObj>(relu->getOutput(), nullptr, 1.f, 4.f);
+  // t2 被 add 和 mul 两个算子使用，add 不能原地复用 t2
+  auto add = g->addOp<AddObj>(clip->getOutput(), b, nullptr);
+  // mul 是 t2 和 t3 的最后一个使用者，可以原地复用与输出形状相同的输入
+  auto mul = g->addOp<MulObj>(add->getOutput(), clip->getOutput(), nullptr);
+  // Float2Int32 的元素宽度相同，可以原地计算
+  auto cast = g->addOp<CastObj>(mul->getOutput(), nullptr, CastType::Float2Int32);
+  g->dataMalloc();
+
+  auto ptr = [](const Tensor &t) { return t->getRawDataPtr<void *>(); };
+  EXPECT_NE(ptr(relu->getOutput()), ptr(i));
+  EXPECT_EQ(ptr(clip->getOutput()), ptr(relu->getOutput()));
+  EXPECT_NE(ptr(add->getOutput()), ptr(clip->getOutput()));
+  EXPECT_TRUE(ptr(mul->getOutput()) == ptr(add->getOutput()) || ptr(mul->getOutput()) == ptr(clip->getOutput()));
+  EXPECT_EQ(ptr(cast->getOutput()), ptr(mul->getOutput()));
+
+  i->setData(IncrementalGenerator());
+  b->setData(OneGenerator());
+  runtime->run(g);
+  // clip(relu(i)) = [1, 1, 2, 3, 4, 4]，(clip + 1) * clip = [2, 2, 6, 12, 20, 20]
+  auto result = cast->getOutput()->getRawDataPtr<int32_t *>();
+  int32_t expected[] = {2, 2, 6, 12, 20, 20};
+  for (int k = 0; k < 6; ++k) EXPECT_EQ(result[k], expected[k]);
+}
+
+TEST(Graph, PersistentWeights) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto x = g->addTensor({4, 8}, DataType::Float32);
+  auto w = g->addWeight({8}, DataType::Float32);
+  auto c = g->addWeight({8}, DataType::Float32);
+  // w 只被第一个算子使用，之后的中间结果不能复用它的内存
+  auto add = g->addOp<AddObj>(x, w, nullptr);
+  auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+  auto mul = g->addOp<MulObj>(relu->getOutput(), c, nullptr);
+  auto sub = g->addOp<SubObj>(mul->getOutput(), x, nullptr);
+  g->dataMalloc();
+  EXPECT_EQ(g->getInputs(), TensorVec{x});
+  EXPECT_EQ(g->getWeights(), (TensorVec{w, c}));
+
+  // 权重位于常驻的权重内存中，与输入和中间结果的内存不相交
+  auto [dataBase, dataSize] = g->getDataArena();
+  auto [weightBase, weightSize] = g->getWeightArena();
+  EXPECT_GE(weightSize, w->getBytes() + c->getBytes());
+  for (auto &t : {w, c}) {
+    auto p = t->getRawDataPtr<uint8_t *>();
+    EXPECT_TRUE(p >= weightBase && p + t->getBytes() <= weightBase + weightSize);
+    EXPECT_TRUE(p + t->getBytes() <= dataBase || p >= dataBase + dataSize);
+  }
+
+  // 权重只设置一次，之后每次推理只写入输入
+  w->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i) - 3.f;
+  });
+  c->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i % 3) + 1.f;
+  });
+  for (int run = 0; run < 3; ++run) {
+    x->setData([&](void *ptr, size_t size, DataType) {
+      for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float((i + run) % 5) - 2.f;
+    });
+    runtime->run(g);
+    auto out = sub->getOutput()->getRawDataPtr<float *>();
+    for (size_t i = 0; i < 32; ++i) {
+      float xi = float((i + run) % 5) - 2.f, wi = float(i % 8) - 3.f, ci = float(i % 8 % 3) + 1.f;
+      EXPECT_FLOAT_EQ(out[i], std::max(xi + wi, 0.f) * ci - xi);
+    }
+  }
+}
+
+/**
+ * @brief 构建包含嵌套 Concat 的计算图，返回其中的算子（按添加顺序）
+ */
+static OpVec buildConcatGraph(const Graph &g, const Tensor &x, const Tensor &y) {
+  auto relu = g->addOp<ReluObj>(x, nullptr);
+  auto clip = g->addOp<ClipObj>(y, nullptr, -1.f, 2.f);
+  auto relu2 = g->addOp<ReluObj>(y, nullptr);
+  // 第 1 维之前只有大小为 1 的维度，inner 可以消除；inner 的输出又沿最外层的非 1 维度拼接到 outer 中
+  auto inner = g->addOp<ConcatObj>(TensorVec{relu->getOutput(), clip->getOutput()}, nullptr, 1);
+  auto outer = g->addOp<ConcatObj>(TensorVec{inner->getOutput(), relu2->getOutput()}, nullptr, 1);
+  auto add = g->addOp<AddObj>(outer->getOutput(), outer->getOutput(), nullptr);
+  // clip 的输出在 outer 之后还被读取，不能被原地覆盖
+  auto mul = g->addOp<MulObj>(clip->getOutput(), clip->getOutput(), nullptr);
+  // 沿第 2 维拼接时外层维度不是 1，输入在输出中不连续，保留 Concat
+  auto kept = g->addOp<ConcatObj>(TensorVec{mul->getOutput(), clip->getOutput()}, nullptr, 2);
+  return {relu, clip, relu2, inner, outer, add, mul, kept};
+}
+
+TEST(Graph, ConcatElimination) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime), reference = make_ref<GraphObj>(runtime);
+  auto x = g->addTensor({1, 2, 3}, DataType::Float32), y = g->addTensor({1, 3, 3}, DataType::Float32);
+  auto rx = reference->addTensor({1, 2, 3}, DataType::Float32), ry = reference->addTensor({1, 3, 3}, DataType::Float32);
+  auto ops = buildConcatGraph(g, x, y), refOps = buildConcatGraph(reference, rx, ry);
+  g->dataMalloc();
+  reference->setConcatElimination(false);
+  reference->dataMalloc();
+
+  EXPECT_TRUE(g->isElided(ops[3]));
+  EXPECT_TRUE(g->isElided(ops[4]));
+  EXPECT_FALSE(g->isElided(ops[7]));
+  EXPECT_TRUE(std::none_of(refOps.begin(), refOps.end(), [&](const Operator &op) { return reference->isElided(op); }));
+
+  // 生成 Concat 输入的算子直接写入最外层输出中对应的位置
+  auto ptr = [](const Operator &op) { return op->getOutput()->getRawDataPtr<uint8_t *>(); };
+  auto base = ptr(ops[4]);
+  EXPECT_EQ(ptr(ops[3]), base);
+  EXPECT_EQ(ptr(ops[0]), base);
+  EXPECT_EQ(ptr(ops[1]), base + ops[0]->getOutput()->getBytes());
+  EXPECT_EQ(ptr(ops[2]), base + ops[3]->getOutput()->getBytes());
+  auto plan = runtime->compile(g);
+  EXPECT_EQ(plan->getEntries().size(), ops.size() - 2);
+
+  // 结果与不消除 Concat 时相同
+  auto setInputs = [](const Tensor &x, const Tensor &y, int run) {
+    x->setData([&](void *p, size_t size, DataType) {
+      for (size_t i = 0; i < size; ++i) static_cast<float *>(p)[i] = float((i + run) % 5) - 2.f;
+    });
+    y->setData([&](void *p, size_t size, DataType) {
+      for (size_t i = 0; i < size; ++i) static_cast<float *>(p)[i] = float((i * 2 + run) % 7) - 3.f;
+    });
+  };
+  auto result = [](const Operator &op) {
+    auto p = op->getOutput()->getRawDataPtr<float *>();
+    return vector<float>(p, p + op->getOutput()->size());
+  };
+  for (int run = 0; run < 2; ++run) {
+    setInputs(rx, ry, run);
+    runtime->run(reference);
+    setInputs(x, y, run);
+    runtime->run(g);
+    EXPECT_EQ(result(ops[5]), result(refOps[5]));
+    EXPECT_EQ(result(ops[7]), result(refOps[7]));
+    setInputs(x, y, run);
+    runtime->run(plan);
+    EXPECT_EQ(result(ops[5]), result(refOps[5]));
+    EXPECT_EQ(result(ops[7]), result(refOps[7]));
+  }
+}
+}  // namespace infini
@@ -0,0 +1,57 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/plan.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/transpose.h"
+#include "test.h"
+
+namespace infini {
+
+TEST(KernelRegistry, DispatchByDType) {
+  const auto &registry = KernelRegistry::getInstance();
+  const auto add = OpType(OpType::Add).underlying();
+  // 每个数据类型注册各自实例化的 kernel，名称相同
+  auto &f32 = registry.getKernelItem(KernelAttrs{Device::CPU, add, DataType::Float32.getIndex()});
+  auto &i64 = registry.getKernelItem(KernelAttrs{Device::CPU, add, DataType::Int64.getIndex()});
+  EXPECT_NE(std::get<0>(f32), std::get<0>(i64));
+  EXPECT_EQ(std::get<1>(f32), std::get<1>(i64));
+  // 没有注册的数据类型查找失败
+  EXPECT_ANY_THROW(registry.getKernelItem(KernelAttrs{Device::CPU, add, DataType::Float16.getIndex()}));
+  // 不区分数据类型的 kernel 对任意数据类型都能找到
+  const auto transpose = OpType(OpType::Transpose).underlying();
+  EXPECT_EQ(std::get<0>(registry.getKernelItem(KernelAttrs{Device::CPU, transpose, DataType::Int8.getIndex()})),
+            std::get<0>(registry.getKernelItem(KernelAttrs{Device::CPU, transpose, DataType::Float32.getIndex()})));
+}
+
+TEST(KernelRegistry, Int64Add) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto a = g->addTensor({2, 3}, DataType::Int64);
+  auto b = g->addTensor({3}, DataType::Int64);
+  auto output = g->addOp<AddObj>(a, b, nullptr)->getOutput();
+  g->dataMalloc();
+  a->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<int64_t *>(ptr)[i] = (int64_t(1) << 40) + int64_t(i);
+  });
+  b->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<int64_t *>(ptr)[i] = -int64_t(i) * 10;
+  });
+  runtime->run(runtime->compile(g));
+  auto ptr = output->getRawDataPtr<int64_t *>();
+  for (size_t i = 0; i < output->size(); ++i) EXPECT_EQ(ptr[i], (int64_t(1) << 40) + int64_t(i) - int64_t(i % 3) * 10);
+}
+
+TEST(KernelRegistry, UnsupportedDTypeFailsAtCompile) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto a = g->addTensor({4, 8}, DataType::Int32);
+  auto b = g->addTensor({8, 2}, DataType::Int32);
+  g->addOp<MatmulObj>(a, b, nullptr);
+  g->dataMalloc();
+  // 矩阵乘只注册了 Float32，编译执行计划时报错而不是在执行时
+  EXPECT_ANY_THROW(runtime->compile(g));
+}
+
+}  // namespace infini
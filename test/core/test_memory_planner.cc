@@ -0,0 +1,116 @@
+#include <random>
+
+#include "core/graph.h"
+#include "core/memory_planner.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+#include "test.h"
+
+namespace infini {
+
+// 生命周期重叠的内存块不能重叠，规划的大小覆盖所有内存块且不小于下界
+static void checkPlan(const vector<LiveInterval> &intervals, const MemoryPlan &plan) {
+  ASSERT_EQ(plan.offsets.size(), intervals.size());
+  EXPECT_GE(plan.size, plan.lowerBound);
+  for (size_t a = 0; a < intervals.size(); ++a) {
+    EXPECT_LE(plan.offsets[a] + intervals[a].bytes, plan.size);
+    EXPECT_EQ(plan.offsets[a] % intervals[a].alignment, 0u);
+    for (size_t b = a + 1; b < intervals.size(); ++b) {
+      bool alive = intervals[a].begin <= intervals[b].end && intervals[b].begin <= intervals[a].end;
+      bool disjoint = plan.offsets[a] + intervals[a].bytes <= plan.offsets[b] ||
+                      plan.offsets[b] + intervals[b].bytes <= plan.offsets[a];
+      EXPECT_TRUE(!alive || disjoint || !intervals[a].bytes || !intervals[b].bytes);
+    }
+  }
+}
+
+TEST(MemoryPlanner, LowerBound) {
+  // 第 1 步同时存活 a、b、c，共 24 字节
+  vector<LiveInterval> intervals{{8, 0, 1}, {8, 1, 2}, {8, 1, 1}, {16, 2, 3}};
+  auto live = MemoryPlanner::getLiveBytes(intervals, 4);
+  EXPECT_EQ(live, (vector<size_t>{8, 24, 24, 16}));
+  auto plan = MemoryPlanner().plan(intervals, 4);
+  checkPlan(intervals, plan);
+  EXPECT_EQ(plan.lowerBound, 24u);
+  EXPECT_EQ(plan.size, 24u);
+}
+
+TEST(MemoryPlanner, StrategiesAreValid) {
+  std::mt19937 rng(7);
+  MemoryPlanner planner;
+  for (int trial = 0; trial < 200; ++trial) {
+    const size_t steps = 2 + rng() % 8, count = 2 + rng() % 9;
+    vector<LiveInterval> intervals;
+    for (size_t i = 0; i < count; ++i) {
+      size_t begin = rng() % steps, end = begin + rng() % (steps - begin);
+      // 一部分内存块要求更大的对齐
+      intervals.push_back({8 * (1 + rng() % 8), begin, end, size_t(8) << (rng() % 4)});
+    }
+    auto bySize = MemoryPlanner::greedyBySize(intervals, steps);
+    auto byBreadth = MemoryPlanner::greedyByBreadth(intervals, steps);
+    auto best = planner.plan(intervals, steps);
+    checkPlan(intervals, bySize);
+    checkPlan(intervals, byBreadth);
+    checkPlan(intervals, best);
+    EXPECT_LE(best.size, std::min(bySize.size, byBreadth.size));
+    // 精确搜索的结果不依赖初始上界
+    MemoryPlan loose = bySize;
+    loose.size = std::numeric_limits<size_t>::max() / 2;
+    auto searched = planner.exact(intervals, steps, loose);
+    checkPlan(intervals, searched);
+    if (count <= MemoryPlanner::DefaultExactLimit) {
+      // 默认的精确搜索上限以内，搜索在节点预算内完成，得到的是最优解
+      EXPECT_EQ(searched.strategy, "exact-search");
+      EXPECT_EQ(searched.size, best.size);
+    } else {
+      EXPECT_LE(searched.size, best.size);
+    }
+  }
+}
+
+TEST(MemoryPlanner, ExactBeatsGreedy) {
+  // 两种贪心都先把 24 字节的块放在底部，两个 16 字节的块只能叠放到 56 字节；
+  // 最优解把第一个 16 字节的块放在 24 字节的块之上，第二个放在底部，只需要 40 字节
+  vector<LiveInterval> intervals{{24, 5, 5}, {16, 3, 5}, {24, 1, 2}, {16, 2, 4}, {32, 0, 0}};
+  auto bySize = MemoryPlanner::greedyBySize(intervals, 6);
+  auto byBreadth = MemoryPlanner::greedyByBreadth(intervals, 6);
+  EXPECT_EQ(bySize.size, 56u);
+  EXPECT_EQ(byBreadth.size, 56u);
+  auto best = MemoryPlanner().plan(intervals, 6);
+  checkPlan(intervals, best);
+  EXPECT_EQ(best.size, 40u);
+  EXPECT_EQ(best.size, best.lowerBound);
+  EXPECT_EQ(best.strategy, "exact-search");
+  // 关闭精确搜索时只使用贪心的结果
+  EXPECT_EQ(MemoryPlanner(0).plan(intervals, 6).size, 56u);
+}
+
+TEST(MemoryPlanner, GraphPlan) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  // 一条链和一个较早产生、最后才使用的中间结果
+  auto x = g->addTensor({64}, DataType::Float32);
+  auto skip = g->addOp<ReluObj>(x, nullptr)->getOutput();
+  Tensor t = g->addOp<AddObj>(x, x, nullptr)->getOutput();
+  for (int i = 0; i < 4; ++i) t = g->addOp<MulObj>(t, x, nullptr)->getOutput();
+  auto y = g->addOp<AddObj>(t, skip, nullptr)->getOutput();
+  g->dataMalloc();
+  const auto &plan = g->getMemoryPlan();
+  EXPECT_GE(plan.size, plan.lowerBound);
+  EXPECT_EQ(g->getDataArena().second, plan.size);
+  EXPECT_EQ(g->getLiveBytes().size(), g->getOperators().size());
+
+  x->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i % 5) - 2.f;
+  });
+  runtime->run(g);
+  auto out = y->getRawDataPtr<float *>();
+  for (size_t i = 0; i < y->size(); ++i) {
+    float v = float(i % 5) - 2.f, expected = 2 * v;
+    for (int k = 0; k < 4; ++k) expected *= v;
+    EXPECT_FLOAT_EQ(out[i], expected + std::max(v, 0.f));
+  }
+}
+
+}  // namespace infini
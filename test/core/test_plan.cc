@@ -0,0 +1,279 @@
+#include <atomic>
+#include <cstring>
+
+#include "core/async_runner.h"
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/plan.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include "test.h"
+
+namespace infini {
+
+TEST(Plan, MatchesGraphRun) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto a = g->addTensor({2, 8, 16}, DataType::Float32);
+  auto w = g->addWeight({16, 12}, DataType::Float32);
+  auto bias = g->addTensor({12}, DataType::Float32);
+  auto c = g->addTensor({2, 12, 4}, DataType::Float32);
+  auto matmul = g->addOp<MatmulObj>(a, w, nullptr);
+  auto add = g->addOp<AddObj>(matmul->getOutput(), bias, nullptr);
+  auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+  auto transpose = g->addOp<TransposeObj>(relu->getOutput(), nullptr, vector<int>{0, 2, 1});
+  auto concat = g->addOp<ConcatObj>(TensorVec{transpose->getOutput(), c}, nullptr, 2);
+  auto cast = g->addOp<CastObj>(concat->getOutput(), nullptr, CastType::Float2Int32);
+  g->dataMalloc();
+  w->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i % 7) - 3.f;
+  });
+  g->prepackWeights();
+
+  auto plan = runtime->compile(g);
+  ASSERT_EQ(plan->getEntries().size(), 6u);
+  EXPECT_EQ(plan->getEntries()[0].kernelName, "MatmulGemm_CPU");
+
+  // 图的输入在计算过程中可能被复用，每次执行前都重新写入
+  auto setInputs = [&](float scale) {
+    a->setData([&](void *ptr, size_t size, DataType) {
+      for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = scale * (float(i % 5) - 2.f);
+    });
+    bias->setData([](void *ptr, size_t size, DataType) {
+      for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i) - 6.f;
+    });
+    c->setData([&](void *ptr, size_t size, DataType) {
+      for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = scale * float(i);
+    });
+  };
+  auto output = cast->getOutput();
+  auto result = [&] {
+    auto ptr = output->getRawDataPtr<int32_t *>();
+    return vector<int32_t>(ptr, ptr + output->size());
+  };
+
+  // 执行计划多次，每次都使用新的输入，结果与逐个查找 kernel 的执行方式一致
+  for (float scale : {1.f, -2.f}) {
+    setInputs(scale);
+    runtime->run(g);
+    auto expected = result();
+    setInputs(scale);
+    runtime->run(plan);
+    EXPECT_EQ(result(), expected);
+  }
+}
+
+/**
+ * @brief 构建有四个独立分支的计算图：每个分支为 clip(relu(x + c_k)) * c_k，最后拼接并与权重相乘
+ */
+static Tensor buildWideGraph(const Graph &g, vector<Tensor> &inputs) {
+  auto x = g->addTensor({32, 64}, DataType::Float32);
+  inputs.push_back(x);
+  TensorVec branches;
+  for (int k = 0; k < 4; ++k) {
+    auto c = g->addTensor({64}, DataType::Float32);
+    inputs.push_back(c);
+    auto add = g->addOp<AddObj>(x, c, nullptr);
+    auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+    auto clip = g->addOp<ClipObj>(relu->getOutput(), nullptr, 0.f, 40.f);
+    auto mul = g->addOp<MulObj>(clip->getOutput(), c, nullptr);
+    branches.push_back(mul->getOutput());
+  }
+  auto concat = g->addOp<ConcatObj>(branches, nullptr, 1);
+  auto w = g->addTensor({256, 16}, DataType::Float32);
+  inputs.push_back(w);
+  return g->addOp<MatmulObj>(concat->getOutput(), w, nullptr)->getOutput();
+}
+
+TEST(Plan, ParallelSchedule) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  Graph sequential = make_ref<GraphObj>(runtime), parallel = make_ref<GraphObj>(runtime);
+  vector<Tensor> seqInputs, parInputs;
+  auto seqOutput = buildWideGraph(sequential, seqInputs);
+  auto parOutput = buildWideGraph(parallel, parInputs);
+  sequential->dataMalloc();
+  parallel->dataMalloc(true);
+  EXPECT_TRUE(parallel->isConcurrentMalloc());
+
+  // 可能同时执行的不同分支的中间结果不能共用内存
+  vector<Tensor> reluOutputs;
+  for (auto &op : parallel->getOperators())
+    if (op->getOpType() == OpType::Relu) reluOutputs.push_back(op->getOutput());
+  ASSERT_EQ(reluOutputs.size(), 4u);
+  for (size_t i = 0; i < reluOutputs.size(); ++i)
+    for (size_t j = i + 1; j < reluOutputs.size(); ++j) {
+      auto a = reluOutputs[i]->getRawDataPtr<uint8_t *>(), b = reluOutputs[j]->getRawDataPtr<uint8_t *>();
+      EXPECT_TRUE(a + reluOutputs[i]->getBytes() <= b || b + reluOutputs[j]->getBytes() <= a);
+    }
+
+  auto setInputs = [](vector<Tensor> &inputs, int seed) {
+    for (size_t k = 0; k < inputs.size(); ++k)
+      inputs[k]->setData([&](void *ptr, size_t size, DataType) {
+        for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float((i * 7 + k * 13 + seed) % 11) - 5.f;
+      });
+  };
+  auto result = [](const Tensor &t) {
+    auto ptr = t->getRawDataPtr<float *>();
+    return vector<float>(ptr, ptr + t->size());
+  };
+
+  // 先依次执行得到参考结果，再多次并行执行
+  vector<vector<float>> expected;
+  for (int seed = 0; seed < 20; ++seed) {
+    setInputs(seqInputs, seed);
+    runtime->run(sequential);
+    expected.push_back(result(seqOutput));
+  }
+  auto oldConfig = runtime->getThreadPoolConfig();
+  runtime->setThreadPoolConfig({4});
+  runtime->setScheduleMode(NativeCpuRuntimeObj::ScheduleMode::Parallel);
+  auto plan = runtime->compile(parallel);
+  EXPECT_EQ(plan->getEntries()[0].numPredecessors, 0u);
+  for (int seed = 0; seed < 20; ++seed) {
+    setInputs(parInputs, seed);
+    runtime->run(plan);
+    EXPECT_EQ(result(parOutput), expected[seed]);
+  }
+  runtime->setScheduleMode(NativeCpuRuntimeObj::ScheduleMode::Sequential);
+  runtime->setThreadPoolConfig(oldConfig);
+}
+
+/**
+ * @brief 测试用的 kernel：记录执行次数，输入的第一个字节非 0 时执行失败
+ */
+class FailingKernel : public Kernel {
+ public:
+  static std::atomic<int> launches;
+  void compute(const Operator &op, const RuntimeObj *context) const override {}
+  PreparedKernel prepare(const Operator &op, const RuntimeObj *) const override {
+    const size_t bytes = op->getOutput()->getBytes();
+    return [bytes](void *const *inputs, void *const *outputs) {
+      launches++;
+      if (*static_cast<const uint8_t *>(inputs[0])) throw std::runtime_error("kernel failure");
+      std::memset(outputs[0], 0, bytes);
+    };
+  }
+};
+std::atomic<int> FailingKernel::launches{0};
+
+TEST(Plan, StopsAfterFailure) {
+  // Relu 没有注册 Bool 的 kernel，在这里注册会失败的 kernel
+  KernelRegistry::getInstance().registerKernel(
+      KernelAttrs{Device::CPU, OpType(OpType::Relu).underlying(), DataType::Bool.getIndex()}, new FailingKernel(),
+      "Failing_CPU");
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  auto oldConfig = runtime->getThreadPoolConfig();
+  runtime->setThreadPoolConfig({4});
+  for (auto mode : {NativeCpuRuntimeObj::ScheduleMode::Sequential, NativeCpuRuntimeObj::ScheduleMode::Parallel}) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({64}, DataType::Bool);
+    Tensor t = x;
+    for (int i = 0; i < 4; ++i) t = g->addOp<ReluObj>(t, nullptr)->getOutput();
+    g->dataMalloc(true);
+    x->setData([](void *ptr, size_t size, DataType) { std::memset(ptr, 1, size); });
+    auto plan = runtime->compile(g);
+    runtime->setScheduleMode(mode);
+    // 第一个算子失败后，两种调度方式都不再执行依赖它的算子
+    FailingKernel::launches = 0;
+    EXPECT_ANY_THROW(runtime->run(plan));
+    EXPECT_EQ(FailingKernel::launches.load(), 1);
+    runtime->setScheduleMode(NativeCpuRuntimeObj::ScheduleMode::Sequential);
+  }
+  runtime->setThreadPoolConfig(oldConfig);
+}
+
+TEST(Plan, AsyncRun) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  auto oldConfig = runtime->getAsyncConfig();
+  runtime->setAsyncConfig({2, 2});
+
+  // 两份计算图交替使用：一份在后台执行时准备另一份的输入
+  Graph graphs[2] = {make_ref<GraphObj>(runtime), make_ref<GraphObj>(runtime)};
+  vector<Tensor> inputs[2];
+  Tensor outputs[2];
+  Plan plans[2];
+  for (int b = 0; b < 2; ++b) {
+    outputs[b] = buildWideGraph(graphs[b], inputs[b]);
+    graphs[b]->dataMalloc(true);
+    plans[b] = runtime->compile(graphs[b]);
+  }
+  auto setInputs = [](vector<Tensor> &inputs, int seed) {
+    for (size_t k = 0; k < inputs.size(); ++k)
+      inputs[k]->setData([&](void *ptr, size_t size, DataType) {
+        for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float((i * 5 + k * 3 + seed) % 9) - 4.f;
+      });
+  };
+  auto result = [](const Tensor &t) {
+    auto ptr = t->getRawDataPtr<float *>();
+    return vector<float>(ptr, ptr + t->size());
+  };
+
+  vector<vector<float>> expected;
+  for (int seed = 0; seed < 8; ++seed) {
+    setInputs(inputs[0], seed);
+    runtime->run(plans[0]);
+    expected.push_back(result(outputs[0]));
+  }
+
+  std::future<void> pending[2];
+  for (int seed = 0; seed < 8; ++seed) {
+    const int b = seed % 2;
+    if (pending[b].valid()) {
+      pending[b].get();
+      EXPECT_EQ(result(outputs[b]), expected[seed - 2]);
+    }
+    setInputs(inputs[b], seed);
+    pending[b] = runtime->runAsync(plans[b]);
+  }
+  for (int b = 0; b < 2; ++b) {
+    pending[b].get();
+    EXPECT_EQ(result(outputs[b]), expected[6 + b]);
+  }
+
+  // 回调在执行线程中调用
+  std::promise<void> done;
+  std::atomic<bool> failed{true};
+  setInputs(inputs[1], 3);
+  runtime->runAsync(plans[1], [&](std::exception_ptr error) {
+    failed = static_cast<bool>(error);
+    done.set_value();
+  });
+  done.get_future().get();
+  EXPECT_FALSE(failed.load());
+  EXPECT_EQ(result(outputs[1]), expected[3]);
+
+  // 回调抛出的异常不会终止执行线程；在回调中修改配置会失败，而不是让执行线程等待自己退出
+  std::promise<void> reconfigured;
+  std::atomic<bool> rejected{false};
+  runtime->runAsync(plans[0], [&](std::exception_ptr) { throw std::runtime_error("callback failure"); });
+  runtime->runAsync(plans[0], [&](std::exception_ptr) {
+    try {
+      runtime->setAsyncConfig({1, 1});
+    } catch (const std::exception &) {
+      rejected = true;
+    }
+    reconfigured.set_value();
+  });
+  reconfigured.get_future().get();
+  EXPECT_TRUE(rejected.load());
+  runtime->runAsync(plans[0]).get();
+
+  // 执行中的异常由 future 重新抛出：并行调度要求计算图按并发执行分配内存
+  Graph sequential = make_ref<GraphObj>(runtime);
+  vector<Tensor> seqInputs;
+  buildWideGraph(sequential, seqInputs);
+  sequential->dataMalloc();
+  auto seqPlan = runtime->compile(sequential);
+  runtime->setScheduleMode(NativeCpuRuntimeObj::ScheduleMode::Parallel);
+  auto future = runtime->runAsync(seqPlan);
+  EXPECT_ANY_THROW(future.get());
+  runtime->setScheduleMode(NativeCpuRuntimeObj::ScheduleMode::Sequential);
+
+  runtime->setAsyncConfig(oldConfig);
+}
+
+}  // namespace infini
@@ -0,0 +1,104 @@
+#include "core/graph.h"
+#include "core/plan.h"
+#include "core/profiler.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/matmul.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include "test.h"
+
+namespace infini {
+
+TEST(Profiler, PerOperator) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto a = g->addTensor({8, 16}, DataType::Float32);
+  auto w = g->addTensor({16, 32}, DataType::Float32);
+  auto matmul = g->addOp<MatmulObj>(a, w, nullptr);
+  auto relu = g->addOp<ReluObj>(matmul->getOutput(), nullptr);
+  auto transpose = g->addOp<TransposeObj>(relu->getOutput(), nullptr, vector<int>{1, 0});
+  auto add = g->addOp<AddObj>(transpose->getOutput(), transpose->getOutput(), nullptr);
+  g->dataMalloc();
+  a->setData(IncrementalGenerator());
+  w->setData(IncrementalGenerator());
+
+  auto &profiler = runtime->getProfiler();
+  profiler.reset();
+  runtime->setProfiling(true);
+  runtime->run(g);
+  auto plan = runtime->compile(g);
+  runtime->run(plan);
+  runtime->run(plan);
+  runtime->setProfiling(false);
+  runtime->run(plan);  // 关闭后不再记录
+  EXPECT_EQ(profiler.getNumRuns(), 3u);
+
+  auto records = profiler.getRecords();
+  ASSERT_EQ(records.size(), 4u);
+  for (auto &record : records) {
+    EXPECT_EQ(record.calls, 3u);
+    EXPECT_GE(record.seconds, 0);
+    if (record.opType == string(OpType(OpType::MatMul).toString())) {
+      EXPECT_EQ(record.kernelName, "MatmulGemm_CPU");
+      EXPECT_DOUBLE_EQ(record.flops, 2.0 * 8 * 16 * 32);
+      EXPECT_EQ(record.bytesRead, (8 * 16 + 16 * 32) * sizeof(float));
+      EXPECT_EQ(record.bytesWritten, 8 * 32 * sizeof(float));
+    } else if (record.opType == string(OpType(OpType::Transpose).toString())) {
+      EXPECT_EQ(record.flops, 0);
+    }
+  }
+  for (size_t i = 1; i < records.size(); ++i) EXPECT_GE(records[i - 1].seconds, records[i].seconds);
+  EXPECT_EQ(profiler.getRecordsByOpType().size(), 4u);
+
+  auto summary = profiler.summary();
+  EXPECT_NE(summary.find("By kernel:"), string::npos);
+  EXPECT_NE(summary.find("MatmulGemm_CPU"), string::npos);
+  auto json = profiler.toJson();
+  EXPECT_NE(json.find("\"runs\": 3"), string::npos);
+  EXPECT_NE(json.find("\"by_operator\""), string::npos);
+  profiler.reset();
+  EXPECT_TRUE(profiler.getRecords().empty());
+}
+
+TEST(Profiler, HardwareCounters) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto a = g->addTensor({64, 64}, DataType::Float32);
+  auto relu = g->addOp<ReluObj>(a, nullptr);
+  g->dataMalloc();
+  a->setData(IncrementalGenerator());
+
+  auto &profiler = runtime->getProfiler();
+  profiler.reset();
+  runtime->setProfiling(true);
+  runtime->setHardwareCounters(true);
+  runtime->run(g);
+  runtime->setHardwareCounters(false);
+  runtime->setProfiling(false);
+
+  // 没有权限或 PMU 时只记录耗时
+  auto records = profiler.getRecords();
+  ASSERT_EQ(records.size(), 1u);
+  EXPECT_EQ(records[0].hasCounters, PerfCounters().isAvailable());
+  if (records[0].hasCounters) {
+    EXPECT_GT(records[0].counters[PerfEvent::Instructions], 0u);
+  }
+
+  // 汇总中的 IPC 和缺失率
+  profiler.reset();
+  PerfCounterValues values;
+  values.values = {1000, 2500, 100, 25, 400, 4};
+  profiler.record(relu, "reluNaive_CPU", 1e-6, &values);
+  profiler.record(relu, "reluNaive_CPU", 1e-6, &values);
+  records = profiler.getRecords();
+  EXPECT_EQ(records[0].counters[PerfEvent::Cycles], 2000u);
+  auto summary = profiler.summary();
+  EXPECT_NE(summary.find("Hardware counters by operator:"), string::npos);
+  EXPECT_NE(summary.find("2.50"), string::npos);   // IPC
+  EXPECT_NE(summary.find("25.00"), string::npos);  // LLC 缺失率
+  EXPECT_NE(profiler.toJson().find("\"cache_misses\": 50"), string::npos);
+  profiler.reset();
+}
+
+}  // namespace infini
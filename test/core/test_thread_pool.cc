@@ -0,0 +1,91 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "test.h"
+#include "utils/thread_pool.h"
+
+namespace infini {
+
+TEST(ThreadPool, ParallelFor) {
+  ThreadPool pool({4, false, 0});
+  EXPECT_EQ(pool.getNumThreads(), 4);
+  vector<std::atomic<int>> hits(1000);
+  pool.parallelFor(hits.size(), [&](size_t t) { hits[t]++; });
+  for (auto &h : hits) EXPECT_EQ(h.load(), 1);
+
+  // 在工作线程中嵌套调用 parallelFor 不会死锁
+  std::atomic<int> sum{0};
+  std::promise<void> done;
+  pool.submit([&] {
+    pool.parallelFor(64, [&](size_t t) { sum += t; });
+    done.set_value();
+  });
+  done.get_future().wait();
+  EXPECT_EQ(sum.load(), 64 * 63 / 2);
+
+  // 任务中的异常在调用线程中重新抛出
+  EXPECT_THROW(pool.parallelFor(8,
+                                [](size_t t) {
+                                  if (t == 5) throw std::runtime_error("task failed");
+                                }),
+               std::runtime_error);
+}
+
+TEST(ThreadPool, TaskObserver) {
+  // 记录在其他线程上执行的任务数，begin 和 end 必须在同一个线程中成对调用
+  struct Counter : TaskObserver {
+    std::atomic<int> active{0}, helped{0}, mismatched{0};
+    void begin() override { active++; }
+    void end() override { active--; }
+  };
+  ThreadPool pool({4, false, 0});
+  Counter counter;
+  const auto caller = std::this_thread::get_id();
+  auto previous = setTaskObserver(&counter);
+  EXPECT_EQ(getTaskObserver(), &counter);
+  for (int run = 0; run < 20; ++run) {
+    pool.parallelFor(256, [&](size_t t) {
+      // 调用线程的任务较慢，使其他线程有机会领取任务
+      if (std::this_thread::get_id() == caller) return std::this_thread::sleep_for(std::chrono::microseconds(20));
+      // 在其他线程上执行时观察者已经开始，并传递给嵌套的 parallelFor
+      if (counter.active.load() == 0 || getTaskObserver() != &counter) counter.mismatched++;
+      counter.helped++;
+      if (t % 64 == 0) pool.parallelFor(4, [&](size_t) {
+          if (std::this_thread::get_id() != caller && getTaskObserver() != &counter) counter.mismatched++;
+        });
+    });
+  }
+  setTaskObserver(previous);
+  // parallelFor 返回时所有线程都已经调用了 end
+  EXPECT_EQ(counter.active.load(), 0);
+  EXPECT_EQ(counter.mismatched.load(), 0);
+  EXPECT_GT(counter.helped.load(), 0);
+  EXPECT_EQ(getTaskObserver(), previous);
+}
+
+TEST(ThreadPool, Configure) {
+  ThreadPool pool;
+  EXPECT_EQ(pool.getNumThreads(), getAvailableCpuCount());
+  // 绑核、不自旋，只有一个线程时在调用线程中依次执行
+  for (int threads : {1, 3}) {
+    pool.configure({threads, true, 0});
+    EXPECT_EQ(pool.getNumThreads(), threads);
+    std::atomic<int> count{0};
+    pool.parallelFor(10, [&](size_t) { count++; });
+    EXPECT_EQ(count.load(), 10);
+  }
+
+  // CPU 运行时拥有线程池，kernel 通过 context 使用
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  auto oldConfig = runtime->getThreadPoolConfig();
+  runtime->setThreadPoolConfig({2});
+  EXPECT_EQ(static_cast<const RuntimeObj *>(runtime.get())->getThreadPool()->getNumThreads(), 2);
+  runtime->setThreadPoolConfig(oldConfig);
+}
+
+}  // namespace infini
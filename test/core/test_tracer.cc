@@ -0,0 +1,52 @@
+#include "core/graph.h"
+#include "core/plan.h"
+#include "core/runtime.h"
+#include "core/tracer.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+#include "test.h"
+
+namespace infini {
+
+TEST(Tracer, ChromeTrace) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto a = g->addTensor({4, 64}, DataType::Float32);
+  auto b = g->addTensor({64}, DataType::Float32);
+  auto add = g->addOp<AddObj>(a, b, nullptr);
+  auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+  g->addOp<MulObj>(relu->getOutput(), b, nullptr);
+  g->dataMalloc();
+  ASSERT_EQ(g->getLiveBytes().size(), 3u);
+  EXPECT_GE(g->getLiveBytes()[0], (4 * 64 * 2 + 64) * sizeof(float));
+  a->setData(IncrementalGenerator());
+  b->setData(IncrementalGenerator());
+
+  auto &tracer = runtime->getTracer();
+  tracer.reset();
+  runtime->setTracing(true);
+  runtime->run(g);
+  runtime->run(runtime->compile(g));
+  runtime->setTracing(false);
+  runtime->run(g);
+  EXPECT_EQ(tracer.getNumSlices(), 6u);
+
+  auto json = tracer.toJson();
+  EXPECT_EQ(json.find("{\"displayTimeUnit\""), 0u);
+  EXPECT_NE(json.find("\"ph\": \"X\""), string::npos);
+  EXPECT_NE(json.find("\"name\": \"live bytes\", \"ph\": \"C\""), string::npos);
+  EXPECT_NE(json.find("\"kernel\": \"reluNaive_CPU\""), string::npos);
+  EXPECT_NE(json.find("\"dtype\": \"Float32\""), string::npos);
+  EXPECT_NE(json.find("\"offset\": 0"), string::npos);
+  tracer.reset();
+  EXPECT_EQ(tracer.getNumSlices(), 0u);
+
+  // kernel 名称中的引号、反斜杠和控制字符被转义
+  auto now = Tracer::Clock::now();
+  tracer.record(relu, "quote\"back\\slash\nnew\x01", g->getDataArena(), now, now, 0);
+  EXPECT_NE(tracer.toJson().find("\"kernel\": \"quote\\\"back\\\\slash\\nnew\\u0001\""), string::npos);
+  tracer.reset();
+  EXPECT_ANY_THROW(tracer.writeJson("/nonexistent-dir/trace.json"));
+}
+
+}  // namespace infini
@@ -0,0 +1,210 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/plan.h"
+#include "core/runtime.h"
+#include "core/tuner.h"
+#include "operators/matmul.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+#include "test.h"
+#include "utils/cpu_info.h"
+
+namespace infini {
+
+/**
+ * @brief 构建 transpose -> matmul 的计算图，B 是预打包的权重
+ */
+static Graph buildGraph(Runtime runtime, Tensor &output) {
+  Graph g = make_ref<GraphObj>(runtime);
+  auto a = g->addTensor({3, 40, 24}, DataType::Float32);
+  auto w = g->addWeight({40, 56}, DataType::Float32);
+  auto transpose = g->addOp<TransposeObj>(a, nullptr, vector<int>{0, 2, 1});
+  output = g->addOp<MatmulObj>(transpose->getOutput(), w, nullptr)->getOutput();
+  g->dataMalloc();
+  w->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i % 9) - 4.f;
+  });
+  g->prepackWeights();
+  return g;
+}
+
+static void setInput(const Graph &g) {
+  g->getInputs()[0]->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i % 13) - 6.f;
+  });
+}
+
+TEST(KernelTuner, CandidatesMatchDefault) {
+  const auto &registry = KernelRegistry::getInstance();
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  for (auto type : {OpType::Transpose, OpType::MatMul}) {
+    const auto &candidates = registry.getKernelCandidates(
+        KernelAttrs{Device::CPU, OpType(type).underlying(), DataType::Float32.getIndex()});
+    ASSERT_GE(candidates.size(), 2u);
+
+    // 每个候选的结果都与默认实现相同
+    Tensor output;
+    Graph g = buildGraph(runtime, output);
+    setInput(g);
+    runtime->run(g);
+    vector<float> expected(output->getRawDataPtr<float *>(), output->getRawDataPtr<float *>() + output->size());
+    for (auto &[kernel, name, id] : candidates) {
+      for (auto &op : g->getOperators())
+        if (op->getOpType() == type) op->setKernelName(name);
+      g->prepackWeights();
+      setInput(g);
+      runtime->run(g);
+      EXPECT_TRUE(output->equalData(expected)) << name;
+    }
+  }
+}
+
+TEST(KernelTuner, TuneAndCache) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  const string cachePath = ::testing::TempDir() + "infini_tuning_cache.txt";
+  std::remove(cachePath.c_str());
+
+  Tensor output;
+  Graph reference = buildGraph(runtime, output);
+  setInput(reference);
+  runtime->run(reference);
+  vector<float> expected(output->getRawDataPtr<float *>(), output->getRawDataPtr<float *>() + output->size());
+
+  // 调优选出的 kernel 记录在算子中，执行计划使用选中的 kernel，结果不变
+  runtime->setTuning(true, cachePath);
+  Graph g = buildGraph(runtime, output);
+  auto plan = runtime->compile(g);
+  runtime->setTuning(false);
+  const auto &registry = KernelRegistry::getInstance();
+  for (auto &entry : plan->getEntries())
+    EXPECT_EQ(entry.kernelName, std::get<1>(registry.getKernelItem(Device::CPU, entry.op)));
+  setInput(g);
+  runtime->run(plan);
+  EXPECT_TRUE(output->equalData(expected));
+
+  // 选择写入了缓存文件，新的调优器直接读取，不再测量
+  std::ifstream file(cachePath);
+  ASSERT_TRUE(file.good());
+  KernelTuner tuner(cachePath);
+  auto choices = tuner.getChoices();
+  ASSERT_EQ(choices.size(), 2u);
+  for (auto &op : g->getOperators()) {
+    auto it = choices.find(op->getTuningKey());
+    ASSERT_NE(it, choices.end());
+    EXPECT_EQ(it->second, std::get<1>(registry.getKernelItem(Device::CPU, op)));
+  }
+  std::remove(cachePath.c_str());
+}
+
+TEST(KernelTuner, CacheIsPerCpu) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  const string cachePath = ::testing::TempDir() + "infini_tuning_cache_cpu.txt";
+  // 其他 CPU 的记录和没有 CPU 标识的旧格式记录都不会被使用，其他 CPU 的记录保存时原样保留
+  Tensor output;
+  Graph g = buildGraph(runtime, output);
+  const string key = g->getOperators()[0]->getTuningKey();
+  {
+    std::ofstream file(cachePath);
+    file << "Other CPU;isa=\t" << key << "\tTransposeNaive_CPU\n" << key << "\tTransposeNaive_CPU\n";
+  }
+  KernelTuner tuner(cachePath);
+  EXPECT_TRUE(tuner.getChoices().empty());
+  tuner.tune(g, runtime.get());
+  EXPECT_EQ(tuner.getChoices().size(), 2u);
+
+  std::ifstream file(cachePath);
+  vector<string> lines;
+  for (string line; std::getline(file, line);) lines.push_back(line);
+  ASSERT_EQ(lines.size(), 3u);
+  EXPECT_EQ(lines[0], "Other CPU;isa=\t" + key + "\tTransposeNaive_CPU");
+  for (size_t i = 1; i < lines.size(); ++i) EXPECT_EQ(lines[i].compare(0, getCpuSignature().size(), getCpuSignature()), 0);
+  std::remove(cachePath.c_str());
+}
+
+TEST(KernelTuner, PreservesGraphData) {
+  // t = relu(x) 之后 x 不再使用，transpose 的输出 u 可以复用 x 的内存。
+  // 编译时调优不能在计算图的内存中测量，否则会覆盖已经写好的输入 x
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto x = g->addTensor({64, 48}, DataType::Float32);
+  auto t = g->addOp<ReluObj>(x, nullptr)->getOutput();
+  auto u = g->addOp<TransposeObj>(t, nullptr, vector<int>{1, 0})->getOutput();
+  auto y = g->addOp<ReluObj>(u, nullptr)->getOutput();
+  g->dataMalloc();
+  x->setData([](void *ptr, size_t size, DataType) {
+    for (size_t i = 0; i < size; ++i) static_cast<float *>(ptr)[i] = float(i % 17);
+  });
+  vector<float> input(x->getRawDataPtr<float *>(), x->getRawDataPtr<float *>() + x->size());
+
+  runtime->setTuning(true);
+  auto plan = runtime->compile(g);
+  runtime->setTuning(false);
+  EXPECT_TRUE(x->equalData(input));
+  runtime->run(plan);
+  auto result = y->getRawDataPtr<float *>();
+  for (int i = 0; i < 48; ++i)
+    for (int j = 0; j < 64; ++j) ASSERT_EQ(result[i * 64 + j], float((j * 48 + i) % 17));
+}
+
+/**
+ * @brief 测试用的候选 kernel：打包时把 size 字节的缓冲填满，执行时把输入复制到输出，throws 为 true 时执行失败
+ */
+class FakePrepackKernel : public Kernel {
+  size_t size;
+  bool throws;
+
+ public:
+  FakePrepackKernel(size_t size, bool throws) : size(size), throws(throws) {}
+  void compute(const Operator &op, const RuntimeObj *context) const override {}
+  size_t getPrepackSize(const Operator &, const RuntimeObj *) const override { return size; }
+  void prepack(const Operator &, const RuntimeObj *, void *buffer) const override { std::memset(buffer, 0x5a, size); }
+  PreparedKernel prepare(const Operator &op, const RuntimeObj *) const override {
+    const size_t bytes = op->getOutput()->getBytes();
+    const bool fail = throws;
+    return [bytes, fail](void *const *inputs, void *const *outputs) {
+      if (fail) throw std::runtime_error("fake kernel failure");
+      std::memcpy(outputs[0], inputs[0], bytes);
+    };
+  }
+};
+
+TEST(KernelTuner, KeepsPrepackedLayout) {
+  // Relu 没有注册 Bool 的 kernel，在这里注册打包大小不同的候选：默认实现 64 字节，另一个 4096 字节
+  auto &registry = KernelRegistry::getInstance();
+  const KernelAttrs attrs{Device::CPU, OpType(OpType::Relu).underlying(), DataType::Bool.getIndex()};
+  registry.registerKernel(attrs, new FakePrepackKernel(64, false), "FakeSmall_CPU");
+  registry.registerKernel(attrs, new FakePrepackKernel(4096, false), "FakeLarge_CPU");
+  registry.registerKernel(attrs, new FakePrepackKernel(64, true), "FakeThrows_CPU");
+
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto x = g->addTensor({64}, DataType::Bool);
+  auto op = g->addOp<ReluObj>(x, nullptr);
+  g->dataMalloc();
+  g->prepackWeights();
+  const Blob prepacked = op->getPrepackedData();
+  ASSERT_TRUE(prepacked);
+
+  // 缓存中的选择打包大小不同，不能重新打包到 64 字节的缓冲中，保留默认实现
+  const string cachePath = ::testing::TempDir() + "infini_tuning_cache_prepack.txt";
+  {
+    std::ofstream file(cachePath);
+    file << getCpuSignature() << '\t' << op->getTuningKey() << "\tFakeLarge_CPU\n";
+  }
+  KernelTuner cachedTuner(cachePath);
+  cachedTuner.tune(g, runtime.get());
+  EXPECT_EQ(op->getKernelName(), "");
+  EXPECT_EQ(op->getPrepackedData(), prepacked);
+  std::remove(cachePath.c_str());
+
+  // 测量中的异常传给调用者，算子仍然使用原来的打包数据
+  KernelTuner tuner("");
+  EXPECT_ANY_THROW(tuner.tune(g, runtime.get()));
+  EXPECT_EQ(op->getPrepackedData(), prepacked);
+}
+
+}  // namespace infini
@@ -0,0 +1,122 @@
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+#include "test.h"
+#include "utils/float16.h"
+
+namespace infini {
+
+/**
+ * @brief 构建只有一个 Cast 算子的计算图，用 input 作为输入运行，返回输出
+ */
+template <typename TIn, typename TOut>
+static vector<TOut> runCast(const vector<TIn> &input, DataType dtype, CastType type) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto t = g->addTensor({(int)input.size()}, dtype);
+  auto op = g->addOp<CastObj>(t, nullptr, type);
+  g->dataMalloc();
+  t->setData([&](void *ptr, size_t, DataType) { std::copy(input.begin(), input.end(), (TIn *)ptr); });
+  runtime->run(g);
+  auto out = op->getOutput()->getRawDataPtr<TOut *>();
+  return vector<TOut>(out, out + input.size());
+}
+
+TEST(Cast, Float16Software) {
+  EXPECT_EQ(fp32ToFp16(1.f), 0x3c00);
+  EXPECT_EQ(fp32ToFp16(-0.f), 0x8000);
+  EXPECT_EQ(fp32ToFp16(65504.f), 0x7bff);
+  EXPECT_EQ(fp32ToFp16(65519.f), 0x7bff);
+  EXPECT_EQ(fp32ToFp16(65520.f), 0x7c00);
+  EXPECT_EQ(fp32ToFp16(std::ldexp(1.f, -24)), 0x0001);
+  EXPECT_EQ(fp32ToFp16(std::ldexp(1.f, -25)), 0x0000);       // 正好一半，舍入到偶数
+  EXPECT_EQ(fp32ToFp16(std::ldexp(1.5f, -24)), 0x0002);      // 正好一半，舍入到偶数
+  EXPECT_EQ(fp32ToFp16(std::ldexp(1.f, -14)), 0x0400);       // 最小的规格化数
+  EXPECT_EQ(fp32ToFp16(1.f + std::ldexp(1.f, -11)), 0x3c00);  // 正好一半，舍入到偶数
+  EXPECT_EQ(fp32ToFp16(std::nanf("")), 0x7e00);
+  EXPECT_EQ(fp32ToBf16(1.f), 0x3f80);
+  EXPECT_EQ(fp32ToBf16(bitsToFp32(0x3f808000)), 0x3f80);  // 正好一半，舍入到偶数
+  EXPECT_EQ(fp32ToBf16(bitsToFp32(0x3f818000)), 0x3f82);
+  EXPECT_EQ(fp32ToBf16(bitsToFp32(0x00400000)), 0x0000);  // 非规格化数视为 0
+  EXPECT_EQ(fp32ToBf16(bitsToFp32(0x7f7fffff)), 0x7f80);  // 舍入后溢出为 Inf
+  EXPECT_EQ(fp32ToBf16(bitsToFp32(0xff800001)), 0xffc0);  // signaling NaN 变为 quiet NaN
+
+  // 所有非 NaN 的 float16 转换为 float32 之后再转换回来保持不变
+  for (uint32_t h = 0; h < 0x10000; ++h) {
+    float f = fp16ToFp32(h);
+    if (std::isnan(f)) {
+      EXPECT_EQ(fp32ToFp16(f), h | 0x200);
+      continue;
+    }
+    ASSERT_EQ(fp32ToFp16(f), h);
+    ASSERT_EQ(fp32ToBits(bf16ToFp32(fp32ToBf16(f))) >> 16, fp32ToBf16(f));
+  }
+}
+
+TEST(Cast, NativeCpuHalf) {
+  // 覆盖所有指数范围的随机位模式，Cast 内核（可能使用硬件转换指令）的结果必须与软件实现逐位一致
+  std::mt19937 gen(0);
+  vector<float> floats(100003);
+  for (auto &v : floats) v = bitsToFp32(gen());
+  floats[0] = std::ldexp(1.f, -25), floats[1] = 65520.f, floats[2] = -std::ldexp(3.f, -26);
+  auto fp16 = runCast<float, uint16_t>(floats, DataType::Float32, CastType::Float2Float16);
+  auto bf16 = runCast<float, uint16_t>(floats, DataType::Float32, CastType::Float2BFloat16);
+  for (size_t i = 0; i < floats.size(); ++i) {
+    ASSERT_EQ(fp16[i], fp32ToFp16(floats[i])) << "at " << i;
+    ASSERT_EQ(bf16[i], fp32ToBf16(floats[i])) << "at " << i;
+  }
+
+  vector<uint16_t> halves(0x10000);
+  for (uint32_t h = 0; h < 0x10000; ++h) halves[h] = h;
+  auto fromFp16 = runCast<uint16_t, float>(halves, DataType::Float16, CastType::Float162Float);
+  auto fromBf16 = runCast<uint16_t, float>(halves, DataType::BFloat16, CastType::BFloat162Float);
+  for (uint32_t h = 0; h < 0x10000; ++h) {
+    ASSERT_EQ(fp32ToBits(fromFp16[h]), fp32ToBits(fp16ToFp32(h))) << "at " << h;
+    ASSERT_EQ(fp32ToBits(fromBf16[h]), (uint32_t)h << 16) << "at " << h;
+  }
+}
+
+TEST(Cast, NativeCpuInteger) {
+  vector<float> floats{-2.7f, -1.f, 0.f, 0.5f, 1.9f, 100.f};
+  EXPECT_EQ((runCast<float, int32_t>(floats, DataType::Float32, CastType::Float2Int32)),
+            (vector<int32_t>{-2, -1, 0, 0, 1, 100}));
+  EXPECT_EQ((runCast<float, int64_t>(floats, DataType::Float32, CastType::Float2Int64)),
+            (vector<int64_t>{-2, -1, 0, 0, 1, 100}));
+  EXPECT_EQ((runCast<float, int8_t>(floats, DataType::Float32, CastType::Float2Int8)),
+            (vector<int8_t>{-2, -1, 0, 0, 1, 100}));
+
+  // 超出范围的值饱和到目标类型的边界，NaN 转换为 0
+  const float inf = std::numeric_limits<float>::infinity(), nan = std::nanf("");
+  vector<float> extremes{nan, inf, -inf, 127.5f, -128.9f, -129.f, 3e9f, -3e9f, 2147483520.f, 1e19f, -1e19f};
+  EXPECT_EQ((runCast<float, int8_t>(extremes, DataType::Float32, CastType::Float2Int8)),
+            (vector<int8_t>{0, 127, -128, 127, -128, -128, 127, -128, 127, 127, -128}));
+  EXPECT_EQ((runCast<float, int16_t>(extremes, DataType::Float32, CastType::Float2Int16)),
+            (vector<int16_t>{0, 32767, -32768, 127, -128, -129, 32767, -32768, 32767, 32767, -32768}));
+  const int32_t i32max = std::numeric_limits<int32_t>::max(), i32min = std::numeric_limits<int32_t>::min();
+  EXPECT_EQ((runCast<float, int32_t>(extremes, DataType::Float32, CastType::Float2Int32)),
+            (vector<int32_t>{0, i32max, i32min, 127, -128, -129, i32max, i32min, 2147483520, i32max, i32min}));
+  const int64_t i64max = std::numeric_limits<int64_t>::max(), i64min = std::numeric_limits<int64_t>::min();
+  EXPECT_EQ((runCast<float, int64_t>(extremes, DataType::Float32, CastType::Float2Int64)),
+            (vector<int64_t>{0, i64max, i64min, 127, -128, -129, 3000000000, -3000000000, 2147483520, i64max, i64min}));
+
+  vector<int32_t> ints{-70000, -129, -1, 0, 255, 40000};
+  EXPECT_EQ((runCast<int32_t, int16_t>(ints, DataType::Int32, CastType::Int322Int16)),
+            (vector<int16_t>{(int16_t)-70000, -129, -1, 0, 255, (int16_t)40000}));
+  EXPECT_EQ((runCast<int32_t, int8_t>(ints, DataType::Int32, CastType::Int322Int8)),
+            (vector<int8_t>{(int8_t)-70000, 127, -1, 0, -1, (int8_t)40000}));
+  EXPECT_EQ((runCast<int32_t, float>(ints, DataType::Int32, CastType::Int322Float)),
+            (vector<float>{-70000, -129, -1, 0, 255, 40000}));
+
+  vector<uint8_t> bytes{0, 1, 128, 255};
+  EXPECT_EQ((runCast<uint8_t, int64_t>(bytes, DataType::UInt8, CastType::Uint82Int64)),
+            (vector<int64_t>{0, 1, 128, 255}));
+  vector<int64_t> longs{-1, 0, 1ll << 32, 12345};
+  EXPECT_EQ((runCast<int64_t, uint32_t>(longs, DataType::Int64, CastType::Int642Uint32)),
+            (vector<uint32_t>{0xffffffffu, 0, 0, 12345}));
+}
+
+}  // namespace infini
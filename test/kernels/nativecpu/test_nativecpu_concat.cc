@@ -1,5 +1,8 @@
+#include <random>
+
 #include "core/graph.h"
 #include "core/runtime.h"
+#include "kernels/cpu/concat.h"
 #include "operators/concat.h"
 #include "test.h"
 
@@ -24,4 +27,57 @@ TEST(Concat, NativeCpu) {
       vector<float>{0, 1, 2, 1, 1, 1, 3, 4, 5, 1, 1, 1, 6, 7, 8, 1, 1, 1, 9, 10, 11, 1, 1, 1}));
 }
 
+/**
+ * @brief 按输出下标逐元素计算参考结果，检查 concat 的输出
+ */
+template <typename T>
+static void testConcatNativeCpu(const vector<Shape> &shapes, int dim, DataType dtype) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  TensorVec inputs;
+  for (const auto &shape : shapes) inputs.push_back(g->addTensor(shape, dtype));
+  auto op = g->addOp<ConcatObj>(inputs, nullptr, dim);
+  g->dataMalloc();
+  std::mt19937 gen(dim);
+  vector<vector<T>> data;
+  for (auto &input : inputs) {
+    data.emplace_back(input->size());
+    for (auto &v : data.back()) v = (T)gen();
+    input->setData([&](void *ptr, size_t, DataType) { std::copy(data.back().begin(), data.back().end(), (T *)ptr); });
+  }
+  runtime->run(g);
+
+  auto outDim = op->getOutput()->getDims();
+  size_t inner = 1;
+  for (size_t i = dim + 1; i < outDim.size(); ++i) inner *= outDim[i];
+  auto result = op->getOutput()->getRawDataPtr<T *>();
+  for (size_t o = 0; o < op->getOutput()->size(); ++o) {
+    size_t row = o / (outDim[dim] * inner), axis = o / inner % outDim[dim], k = o % inner;
+    size_t i = 0;
+    while (axis >= (size_t)shapes[i][dim]) axis -= shapes[i++][dim];
+    ASSERT_EQ(result[o], data[i][(row * shapes[i][dim] + axis) * inner + k]) << "at " << o;
+  }
+}
+
+TEST(Concat, NativeCpuLarge) {
+  // 最外层维度、最内层维度，以及一行大于单个拷贝任务而被切分的情况
+  testConcatNativeCpu<float>({{3, 5}, {4, 5}, {1, 5}}, 0, DataType::Float32);
+  testConcatNativeCpu<int8_t>({{7, 3, 1}, {7, 3, 5}, {7, 3, 2}}, 2, DataType::Int8);
+  testConcatNativeCpu<int64_t>({{2, 70000}, {2, 1}, {2, 30000}}, 1, DataType::Int64);
+  testConcatNativeCpu<uint16_t>({{64, 3, 100}, {64, 4, 100}}, 1, DataType::Float16);
+}
+
+TEST(Concat, NativeCpuStreaming) {
+  // 降低阈值使较小的输出也使用流式写入：覆盖目标地址不按 16 字节对齐、
+  // 不足 64 字节的尾部、被切分的长行，以及短于流式写入下限而仍使用 memcpy 的段
+  setConcatStreamThreshold(1);
+  EXPECT_EQ(getConcatStreamThreshold(), 1u);
+  testConcatNativeCpu<int8_t>({{5, 3}, {5, 1001}, {5, 100}, {5, 517}}, 1, DataType::Int8);
+  testConcatNativeCpu<float>({{2, 70001}, {2, 7}, {2, 300}}, 1, DataType::Float32);
+  testConcatNativeCpu<uint16_t>({{31, 129}, {17, 129}}, 0, DataType::Float16);
+  // 恢复默认值
+  setConcatStreamThreshold(0);
+  EXPECT_GT(getConcatStreamThreshold(), 1u);
+}
+
 }  // namespace infini
@@ -1,7 +1,10 @@
+#include <random>
+
 #include "core/graph.h"
 #include "core/runtime.h"
 #include "operators/element_wise.h"
 #include "test.h"
+#include "utils/operator_utils.h"
 
 namespace infini {
 
@@ -66,4 +69,90 @@ TEST(ElementWise, NativeCpu) {
                                    ExpectOutput{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
 }
 
+TEST(ElementWise, BroadcastPlan) {
+  // 输出中为 1 的维度被去掉，广播状态相同的相邻维度被合并
+  auto plan = make_broadcast_plan<2>(Shape{2, 1, 3, 4, 5}, {Shape{2, 1, 3, 4, 5}, Shape{4, 5}});
+  EXPECT_EQ(plan.shape, (Shape{6, 20}));
+  EXPECT_EQ(plan.strides[0], (vector<size_t>{20, 1}));
+  EXPECT_EQ(plan.strides[1], (vector<size_t>{0, 1}));
+  EXPECT_EQ(plan.outerSize, 6u);
+  EXPECT_EQ(plan.innerSize, 20u);
+
+  // 最内层被广播时跨度为 0
+  plan = make_broadcast_plan<2>(Shape{3, 4, 5}, {Shape{3, 4, 1}, Shape{1, 4, 5}});
+  EXPECT_EQ(plan.shape, (Shape{3, 4, 5}));
+  EXPECT_EQ(plan.strides[0], (vector<size_t>{4, 1, 0}));
+  EXPECT_EQ(plan.strides[1], (vector<size_t>{0, 5, 1}));
+
+  // 标量
+  plan = make_broadcast_plan<2>(Shape{1, 1}, {Shape{1, 1}, Shape{}});
+  EXPECT_EQ(plan.shape, (Shape{1}));
+  EXPECT_EQ(plan.innerStrides[0], 0u);
+}
+
+TEST(ElementWise, NativeCpuBroadcast) {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dist(1.f, 2.f);
+  // 覆盖连续、最内层标量广播、中间维度广播，以及足够大而启用多线程的情况
+  vector<std::pair<Shape, Shape>> shapes = {{{2, 3, 4}, {2, 3, 4}},     {{2, 3, 4}, {2, 3, 1}},
+                                            {{4, 1, 5}, {3, 1}},        {{1}, {3, 2, 7}},
+                                            {{64, 33, 40}, {33, 1}},    {{8, 1, 128, 64}, {1, 16, 1, 64}}};
+  for (const auto &[shapeA, shapeB] : shapes) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor(shapeA, DataType::Float32);
+    auto b = g->addTensor(shapeB, DataType::Float32);
+    auto op = g->addOp<DivObj>(a, b, nullptr);
+    g->dataMalloc();
+    vector<float> dataA(a->size()), dataB(b->size());
+    for (auto &v : dataA) v = dist(gen);
+    for (auto &v : dataB) v = dist(gen);
+    a->setData([&](void *ptr, size_t, DataType) { std::copy(dataA.begin(), dataA.end(), (float *)ptr); });
+    b->setData([&](void *ptr, size_t, DataType) { std::copy(dataB.begin(), dataB.end(), (float *)ptr); });
+    runtime->run(g);
+
+    // 使用逐元素定位下标的朴素方式计算参考结果
+    auto shapeC = op->getOutput()->getDims();
+    auto rank = shapeC.size();
+    auto pad = [&](const Shape &shape) {
+      Shape padded(rank, 1);
+      std::copy(shape.begin(), shape.end(), padded.begin() + (rank - shape.size()));
+      return padded;
+    };
+    auto stride = [&](const Shape &shape) {
+      Shape ret(rank);
+      for (int i = rank - 1, p = 1; i >= 0; --i) ret[i] = p, p *= shape[i];
+      return ret;
+    };
+    Shape pa = pad(shapeA), pb = pad(shapeB);
+    auto result = op->getOutput()->getRawDataPtr<float *>();
+    for (size_t i = 0; i < op->getOutput()->size(); ++i) {
+      auto index = locate_index(i, shapeC);
+      float expected = dataA[delocate_index(index, pa, stride(pa))] / dataB[delocate_index(index, pb, stride(pb))];
+      ASSERT_EQ(result[i], expected) << "at " << i;
+    }
+  }
+}
+
+TEST(ElementWise, NativeCpuInt32) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto a = g->addTensor({2, 3}, DataType::Int32);
+  auto b = g->addTensor({3}, DataType::Int32);
+  auto op = g->addOp<SubObj>(a, b, nullptr);
+  g->dataMalloc();
+  a->setData([](void *ptr, size_t, DataType) {
+    int32_t data[] = {0, 1, 2, 3, 4, 5};
+    std::copy(data, data + 6, (int32_t *)ptr);
+  });
+  b->setData([](void *ptr, size_t, DataType) {
+    int32_t data[] = {10, -20, 30};
+    std::copy(data, data + 3, (int32_t *)ptr);
+  });
+  runtime->run(g);
+  auto result = op->getOutput()->getRawDataPtr<int32_t *>();
+  int32_t expected[] = {-10, 21, -28, -7, 24, -25};
+  for (int i = 0; i < 6; ++i) EXPECT_EQ(result[i], expected[i]);
+}
+
 }  // namespace infini
@@ -0,0 +1,187 @@
+#include <random>
+
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "kernels/cpu/gemm.h"
+#include "operators/matmul.h"
+#include "test.h"
+
+namespace infini {
+
+/**
+ * @brief 朴素实现的矩阵乘，作为 GEMM 的参考结果
+ */
+static vector<float> referenceGemm(bool transA, bool transB, int m, int n, int k, const vector<float> &A,
+                                   const vector<float> &B) {
+  vector<float> C(m * n, 0.f);
+  for (int i = 0; i < m; ++i)
+    for (int j = 0; j < n; ++j) {
+      double sum = 0;
+      for (int p = 0; p < k; ++p) {
+        float a = transA ? A[p * m + i] : A[i * k + p];
+        float b = transB ? B[j * k + p] : B[p * n + j];
+        sum += (double)a * b;
+      }
+      C[i * n + j] = sum;
+    }
+  return C;
+}
+
+TEST(Matmul, Sgemm) {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  // 覆盖边界块、跨多个 kc 块以及 k 很小的情况
+  vector<std::tuple<int, int, int>> sizes = {{1, 1, 1}, {7, 13, 5}, {33, 65, 300}, {130, 70, 17}, {9, 40, 513}};
+  for (const auto &info : getSgemmKernels()) {
+    for (auto [m, n, k] : sizes) {
+      vector<float> A(m * k), B(k * n);
+      for (auto &v : A) v = dist(gen);
+      for (auto &v : B) v = dist(gen);
+      for (int trans = 0; trans < 4; ++trans) {
+        bool transA = trans & 1, transB = trans & 2;
+        vector<float> C(m * n, -1.f);
+        sgemm(info, transA, transB, m, n, k, A.data(), transA ? m : k, B.data(), transB ? k : n, C.data(), n);
+        auto ref = referenceGemm(transA, transB, m, n, k, A, B);
+        for (int i = 0; i < m * n; ++i) ASSERT_NEAR(C[i], ref[i], 1e-4) << info.name << " at " << i;
+        // 使用预打包的 B 计算，结果应该相同
+        vector<float> packed(sgemmPackedBSize(info, k, n));
+        sgemmPackB(info, transB, k, n, B.data(), transB ? k : n, packed.data());
+        sgemm(info, transA, transB, m, n, k, A.data(), transA ? m : k, nullptr, 0, C.data(), n, packed.data());
+        for (int i = 0; i < m * n; ++i) ASSERT_NEAR(C[i], ref[i], 1e-4) << info.name << " prepacked at " << i;
+      }
+    }
+  }
+}
+
+TEST(Matmul, NativeCpu) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto A = g->addTensor({2, 2, 3}, DataType::Float32);
+  auto B = g->addTensor({2, 3, 2}, DataType::Float32);
+  auto op = g->addOp<MatmulObj>(A, B, nullptr);
+  g->dataMalloc();
+  A->setData(IncrementalGenerator());
+  B->setData(IncrementalGenerator());
+
+  runtime->run(g);
+  EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 2, 2}));
+  EXPECT_TRUE(op->getOutput()->equalData(vector<float>{10, 13, 28, 40, 172, 193, 244, 274}));
+}
+
+TEST(Matmul, NativeCpuTranspose) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  // A^T 的形状为 [2, 3]，B^T 的形状为 [3, 2]
+  auto A = g->addTensor({1, 3, 2}, DataType::Float32);
+  auto B = g->addTensor({1, 2, 3}, DataType::Float32);
+  auto op = g->addOp<MatmulObj>(A, B, nullptr, true, true);
+  g->dataMalloc();
+  A->setData(IncrementalGenerator());
+  B->setData(IncrementalGenerator());
+
+  runtime->run(g);
+  EXPECT_EQ(op->getOutput()->getDims(), (Shape{1, 2, 2}));
+  EXPECT_TRUE(op->getOutput()->equalData(vector<float>{10, 28, 13, 40}));
+}
+
+TEST(Matmul, NativeCpuBroadcast) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  // 使用多于 batch 数的线程，覆盖按 M、N 划分子块的路径
+  auto oldConfig = runtime->getThreadPoolConfig();
+  runtime->setThreadPoolConfig({8});
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  Graph g = make_ref<GraphObj>(runtime);
+  const int m = 37, n = 45, k = 19;
+  // A 的 batch 为 [2, 1]，B 的 batch 为 [3]，输出的 batch 为 [2, 3]
+  auto A = g->addTensor({2, 1, k, m}, DataType::Float32);
+  auto B = g->addTensor({3, k, n}, DataType::Float32);
+  auto op = g->addOp<MatmulObj>(A, B, nullptr, true, false);
+  g->dataMalloc();
+  vector<float> dataA(A->size()), dataB(B->size());
+  for (auto &v : dataA) v = dist(gen);
+  for (auto &v : dataB) v = dist(gen);
+  A->setData([&](void *ptr, size_t size, DataType) { std::copy(dataA.begin(), dataA.end(), (float *)ptr); });
+  B->setData([&](void *ptr, size_t size, DataType) { std::copy(dataB.begin(), dataB.end(), (float *)ptr); });
+
+  runtime->run(g);
+  EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 3, m, n}));
+  vector<float> expected;
+  for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 3; ++j) {
+      vector<float> a(dataA.begin() + i * m * k, dataA.begin() + (i + 1) * m * k);
+      vector<float> b(dataB.begin() + j * k * n, dataB.begin() + (j + 1) * k * n);
+      auto c = referenceGemm(true, false, m, n, k, a, b);
+      expected.insert(expected.end(), c.begin(), c.end());
+    }
+  auto result = op->getOutput()->getRawDataPtr<float *>();
+  for (size_t i = 0; i < expected.size(); ++i) ASSERT_NEAR(result[i], expected[i], 1e-4) << "at " << i;
+  runtime->setThreadPoolConfig(oldConfig);
+}
+
+TEST(Matmul, NativeCpuEmptyBatch) {
+  auto runtime = NativeCpuRuntimeObj::getInstance();
+  auto oldConfig = runtime->getThreadPoolConfig();
+  runtime->setThreadPoolConfig({4});
+  // batch 维度为 0 时输出为空，kernel 直接返回
+  Graph g = make_ref<GraphObj>(runtime);
+  auto A = g->addTensor({0, 4, 4}, DataType::Float32);
+  auto B = g->addTensor({4, 4}, DataType::Float32);
+  auto op = g->addOp<MatmulObj>(A, B, nullptr);
+  g->dataMalloc();
+  runtime->run(g);
+  runtime->run(runtime->compile(g));
+  EXPECT_EQ(op->getOutput()->getDims(), (Shape{0, 4, 4}));
+  EXPECT_EQ(op->getOutput()->size(), 0u);
+  runtime->setThreadPoolConfig(oldConfig);
+}
+
+TEST(Matmul, NativeCpuPrepackWeights) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto A = g->addTensor({2, 3, 9, 20}, DataType::Float32);
+  auto W = g->addWeight({3, 20, 11}, DataType::Float32);
+  auto op = g->addOp<MatmulObj>(A, W, nullptr);
+  g->dataMalloc();
+  A->setData(IncrementalGenerator());
+  W->setData(IncrementalGenerator());
+
+  runtime->run(g);
+  auto output = op->getOutput();
+  vector<float> expected(output->getRawDataPtr<float *>(), output->getRawDataPtr<float *>() + output->size());
+
+  g->prepackWeights();
+  ASSERT_TRUE(op->getPrepackedData() != nullptr);
+  // 打包之后 kernel 不再读取原始的权重，清空原始权重不影响结果
+  W->setData(ZeroGenerator());
+  output->setData(ZeroGenerator());
+  runtime->run(g);
+  EXPECT_TRUE(output->equalData(expected));
+}
+
+TEST(Matmul, NativeCpuRuntimeInputNotPrepacked) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto A = g->addTensor({9, 20}, DataType::Float32);
+  auto B = g->addTensor({20, 11}, DataType::Float32);
+  auto op = g->addOp<MatmulObj>(A, B, nullptr);
+  g->dataMalloc();
+  A->setData(IncrementalGenerator());
+  B->setData(IncrementalGenerator());
+
+  // B 是没有源算子的运行时输入（不是权重），不会被预打包，每次执行都读取它的新数据
+  g->prepackWeights();
+  EXPECT_TRUE(op->getPrepackedData() == nullptr);
+  auto plan = runtime->compile(g);
+  B->setData(ZeroGenerator());
+  runtime->run(g);
+  EXPECT_TRUE(op->getOutput()->equalData(vector<float>(op->getOutput()->size(), 0.f)));
+  B->setData(OneGenerator());
+  runtime->run(plan);
+  auto output = op->getOutput()->getRawDataPtr<float *>();
+  // A 的每一行为 20i, ..., 20i + 19，与全 1 的 B 相乘后每个元素为该行之和
+  for (int i = 0; i < 9; ++i)
+    for (int j = 0; j < 11; ++j) EXPECT_FLOAT_EQ(output[i * 11 + j], float(400 * i + 190));
+}
+
+}  // namespace infini
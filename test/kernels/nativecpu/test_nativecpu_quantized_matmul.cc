@@ -0,0 +1,113 @@
+#include <cmath>
+#include <random>
+
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "kernels/cpu/qgemm.h"
+#include "operators/matmul.h"
+#include "test.h"
+
+namespace infini {
+
+/**
+ * @brief 朴素实现的量化矩阵乘，A、B 都按 [m x k]、[k x n] 存放
+ */
+template <typename TA>
+static vector<float> referenceQgemm(int m, int n, int k, const vector<TA> &A, const vector<int8_t> &B,
+                                    const QgemmQuantParams &params) {
+  vector<float> C(m * n);
+  for (int i = 0; i < m; ++i)
+    for (int j = 0; j < n; ++j) {
+      int c = params.perChannel ? j : 0;
+      int64_t acc = 0;
+      for (int p = 0; p < k; ++p)
+        acc += (int64_t)(A[i * k + p] - params.zeroPointA) * (B[p * n + j] - params.zeroPointB[c]);
+      C[i * n + j] = params.scaleA * params.scaleB[c] * acc;
+    }
+  return C;
+}
+
+template <typename TA>
+static void testQgemm(int m, int n, int k, bool perChannel, ThreadPool *pool = nullptr) {
+  std::mt19937 gen(m * 131 + n * 17 + k);
+  std::uniform_int_distribution<int> dist(-128, 127);
+  vector<TA> A(m * k);
+  vector<int8_t> B(k * n);
+  for (auto &v : A) v = (TA)dist(gen);
+  for (auto &v : B) v = (int8_t)dist(gen);
+  vector<float> scaleB(perChannel ? n : 1);
+  vector<int32_t> zeroPointB(scaleB.size());
+  for (size_t i = 0; i < scaleB.size(); ++i) {
+    scaleB[i] = 0.01f * (1 + i % 7);
+    zeroPointB[i] = (int)(i % 5) - 2;
+  }
+  QgemmQuantParams params{0.05f, std::is_signed_v<TA> ? 3 : 120, scaleB.data(), zeroPointB.data(), perChannel};
+  auto ref = referenceQgemm(m, n, k, A, B, params);
+
+  for (const auto &info : getQgemmKernels()) {
+    vector<float> C(m * n, -1.f);
+    qgemmBatched(info, false, false, m, n, k, {}, {}, {}, A.data(), std::is_signed_v<TA>, B.data(), C.data(),
+                 params, nullptr, pool);
+    for (int i = 0; i < m * n; ++i) ASSERT_NEAR(C[i], ref[i], 1e-3 * std::max(1.f, std::fabs(ref[i]))) << info.name;
+
+    // 使用预打包的 B 计算，结果应该相同
+    vector<uint8_t> packed(qgemmPackedBSize(info, k, n));
+    qgemmPackB(info, false, k, n, B.data(), n, packed.data());
+    qgemmBatched(info, false, false, m, n, k, {}, {}, {}, A.data(), std::is_signed_v<TA>, nullptr, C.data(),
+                 params, packed.data(), pool);
+    for (int i = 0; i < m * n; ++i) ASSERT_NEAR(C[i], ref[i], 1e-3 * std::max(1.f, std::fabs(ref[i]))) << info.name;
+  }
+}
+
+TEST(QuantizedMatmul, Qgemm) {
+  testQgemm<int8_t>(1, 1, 1, false);
+  testQgemm<int8_t>(13, 45, 37, true);
+  testQgemm<uint8_t>(20, 70, 130, true);
+  testQgemm<uint8_t>(9, 33, 6, false);
+}
+
+TEST(QuantizedMatmul, QgemmThreaded) {
+  // 多于 batch 数的线程把矩阵划分为 M x N 的子块；N 很小时只能沿 M 划分
+  ThreadPool pool({6});
+  testQgemm<int8_t>(200, 8, 50, true, &pool);
+  testQgemm<uint8_t>(37, 90, 20, false, &pool);
+  testQgemm<int8_t>(3, 130, 9, true, &pool);
+
+  // batch 维度为 0 时输出为空，直接返回
+  int8_t a = 0, b = 0;
+  float scale = 1.f;
+  int32_t zeroPoint = 0;
+  QgemmQuantParams params{1.f, 0, &scale, &zeroPoint, false};
+  qgemmBatched(getQgemmKernel(), false, false, 4, 4, 4, {0}, {16}, {16}, &a, true, &b, nullptr, params, nullptr, &pool);
+}
+
+TEST(QuantizedMatmul, NativeCpu) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  // A^T 的形状为 [2, 3]，B 的形状为 [3, 2]，B 按输出通道量化
+  auto A = g->addTensor({3, 2}, DataType::Int8);
+  auto B = g->addWeight({3, 2}, DataType::Int8);
+  auto op = g->addOp<QuantizedMatmulObj>(A, B, nullptr, 0.5f, 1, vector<float>{1.f, 2.f}, vector<int32_t>{0, -1},
+                                         true, false);
+  EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 2}));
+  EXPECT_EQ(op->getOutDType(), DataType::Float32);
+  g->dataMalloc();
+  int8_t dataA[] = {1, -2, 3, 4, -5, 6};
+  int8_t dataB[] = {1, 2, -3, 4, 5, -6};
+  A->setData([&](void *ptr, size_t size, DataType) { std::copy(dataA, dataA + 6, (int8_t *)ptr); });
+  B->setData([&](void *ptr, size_t size, DataType) { std::copy(dataB, dataB + 6, (int8_t *)ptr); });
+
+  // (A^T - 1) = [[0, 2, -6], [-3, 3, 5]]，(B - zp) = [[1, 3], [-3, 5], [5, -5]]
+  vector<float> expected{0.5f * 1 * -36, 0.5f * 2 * 40, 0.5f * 1 * 13, 0.5f * 2 * -19};
+  runtime->run(g);
+  EXPECT_TRUE(op->getOutput()->equalData(expected));
+
+  // 预打包权重之后结果不变
+  g->prepackWeights();
+  ASSERT_TRUE(op->getPrepackedData() != nullptr);
+  op->getOutput()->setData(ZeroGenerator());
+  runtime->run(g);
+  EXPECT_TRUE(op->getOutput()->equalData(expected));
+}
+
+}  // namespace infini
@@ -1,3 +1,5 @@
+#include <random>
+
 #include "core/graph.h"
 #include "core/kernel.h"
 #include "core/runtime.h"
@@ -30,4 +32,48 @@ TEST(Transpose, NativeCpu) {
       vector<float>{0, 1, 2, 3, 12, 13, 14, 15, 4, 5, 6, 7, 16, 17, 18, 19, 8, 9, 10, 11, 20, 21, 22, 23}));
 }
 
+/**
+ * @brief 用逐元素计算下标的朴素方式检查转置结果
+ */
+template <typename T>
+static void testTransposeNativeCpu(const Shape &shape, const Shape &permute, DataType dtype) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto input = g->addTensor(shape, dtype);
+  auto op = g->addOp<TransposeObj>(input, nullptr, permute);
+  g->dataMalloc();
+  vector<T> data(input->size());
+  std::mt19937 gen(data.size());
+  for (auto &v : data) v = (T)gen();
+  input->setData([&](void *ptr, size_t, DataType) { std::copy(data.begin(), data.end(), (T *)ptr); });
+  runtime->run(g);
+
+  const int rank = shape.size();
+  auto outShape = op->getOutput()->getDims();
+  auto result = op->getOutput()->getRawDataPtr<T *>();
+  vector<size_t> inStride(rank);
+  for (int i = rank - 1, s = 1; i >= 0; --i) inStride[i] = s, s *= shape[i];
+  for (size_t o = 0; o < data.size(); ++o) {
+    size_t rest = o, inIdx = 0;
+    for (int j = rank - 1; j >= 0; --j) {
+      inIdx += rest % outShape[j] * inStride[permute[j]];
+      rest /= outShape[j];
+    }
+    ASSERT_EQ(result[o], data[inIdx]) << "at " << o;
+  }
+}
+
+TEST(Transpose, NativeCpuPermutations) {
+  // 二维、交换最后两维（带边界块）、最内层不动、合并相邻维度以及长度为 1 的维度
+  testTransposeNativeCpu<float>({67, 131}, {1, 0}, DataType::Float32);
+  testTransposeNativeCpu<float>({3, 70, 9}, {0, 2, 1}, DataType::Float32);
+  testTransposeNativeCpu<float>({4, 5, 6, 7}, {2, 0, 1, 3}, DataType::Float32);
+  testTransposeNativeCpu<float>({2, 3, 1, 4, 5}, {3, 4, 2, 0, 1}, DataType::Float32);
+  testTransposeNativeCpu<float>({8, 1, 16, 130}, {3, 1, 0, 2}, DataType::Float32);
+  testTransposeNativeCpu<uint8_t>({33, 65, 3}, {1, 2, 0}, DataType::UInt8);
+  testTransposeNativeCpu<uint16_t>({5, 3, 17}, {2, 1, 0}, DataType::Float16);
+  testTransposeNativeCpu<int64_t>({2, 40, 70}, {0, 2, 1}, DataType::Int64);
+  testTransposeNativeCpu<float>({1, 1, 5}, {2, 0, 1}, DataType::Float32);
+}
+
 }  // namespace infini
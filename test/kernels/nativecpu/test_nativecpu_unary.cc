@@ -0,0 +1,87 @@
+#include <limits>
+#include <random>
+
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+#include "test.h"
+
+namespace infini {
+
+TEST(Unary, NativeCpuRelu) {
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto input = g->addTensor({2, 3}, DataType::Float32);
+  auto op = g->addOp<ReluObj>(input, nullptr);
+  g->dataMalloc();
+  input->setData([](void *ptr, size_t size, DataType) {
+    float data[] = {-1.5f, 0.f, 2.f, -0.f, 3.5f, -7.f};
+    std::copy(data, data + 6, (float *)ptr);
+  });
+  runtime->run(g);
+  EXPECT_TRUE(op->getOutput()->equalData(vector<float>{0, 0, 2, 0, 3.5, 0}));
+}
+
+TEST(Unary, NativeCpuClip) {
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<float> dist(-10.f, 10.f);
+  // 足够大的张量，覆盖向量化循环的尾部和多线程分块
+  for (auto [minValue, maxValue] : vector<std::pair<std::optional<float>, std::optional<float>>>{
+           {-1.f, 2.5f}, {std::nullopt, 0.f}, {3.f, std::nullopt}}) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({3, 257, 129}, DataType::Float32);
+    auto op = g->addOp<ClipObj>(input, nullptr, minValue, maxValue);
+    g->dataMalloc();
+    vector<float> data(input->size());
+    for (auto &v : data) v = dist(gen);
+    input->setData([&](void *ptr, size_t, DataType) { std::copy(data.begin(), data.end(), (float *)ptr); });
+    runtime->run(g);
+
+    auto result = op->getOutput()->getRawDataPtr<float *>();
+    for (size_t i = 0; i < data.size(); ++i) {
+      float expected = data[i];
+      if (minValue && expected < *minValue) expected = *minValue;
+      if (maxValue && expected > *maxValue) expected = *maxValue;
+      ASSERT_EQ(result[i], expected) << "at " << i;
+    }
+  }
+}
+
+TEST(Unary, NativeCpuClipInt) {
+  // 上下界超出类型的表示范围时截断到该类型的极值
+  Runtime runtime = NativeCpuRuntimeObj::getInstance();
+  Graph g = make_ref<GraphObj>(runtime);
+  auto input = g->addTensor({6}, DataType::Int8);
+  auto op = g->addOp<ClipObj>(input, nullptr, -1000.f, 5.f);
+  g->dataMalloc();
+  input->setData([](void *ptr, size_t, DataType) {
+    int8_t data[] = {-128, -3, 0, 5, 6, 127};
+    std::copy(data, data + 6, (int8_t *)ptr);
+  });
+  runtime->run(g);
+  auto result = op->getOutput()->getRawDataPtr<int8_t *>();
+  int8_t expected[] = {-128, -3, 0, 5, 5, 5};
+  for (int i = 0; i < 6; ++i) EXPECT_EQ(result[i], expected[i]);
+
+  // 64 位整数的最大值转换为 float 后超出表示范围，作为"没有上界"使用的极大值必须饱和到该类型的最大值
+  const float huge = std::numeric_limits<float>::max();
+  Graph g64 = make_ref<GraphObj>(runtime);
+  auto i64 = g64->addTensor({4}, DataType::Int64), u64 = g64->addTensor({4}, DataType::UInt64);
+  auto clipI64 = g64->addOp<ClipObj>(i64, nullptr, -huge, 1e19f);
+  auto clipU64 = g64->addOp<ClipObj>(u64, nullptr, 3.f, huge);
+  g64->dataMalloc();
+  const int64_t i64max = std::numeric_limits<int64_t>::max(), i64min = std::numeric_limits<int64_t>::min();
+  const uint64_t u64max = std::numeric_limits<uint64_t>::max();
+  vector<int64_t> dataI64{i64min, -7, 42, i64max};
+  vector<uint64_t> dataU64{0, 5, uint64_t(1) << 63, u64max};
+  i64->setData([&](void *ptr, size_t, DataType) { std::copy(dataI64.begin(), dataI64.end(), (int64_t *)ptr); });
+  u64->setData([&](void *ptr, size_t, DataType) { std::copy(dataU64.begin(), dataU64.end(), (uint64_t *)ptr); });
+  runtime->run(g64);
+  auto resultI64 = clipI64->getOutput()->getRawDataPtr<int64_t *>();
+  auto resultU64 = clipU64->getOutput()->getRawDataPtr<uint64_t *>();
+  EXPECT_EQ(vector<int64_t>(resultI64, resultI64 + 4), dataI64);
+  EXPECT_EQ(vector<uint64_t>(resultU64, resultU64 + 4), (vector<uint64_t>{3, 5, uint64_t(1) << 63, u64max}));
+}
+
+}  // namespace infini
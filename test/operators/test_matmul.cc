@@ -57,6 +57,25 @@ TEST(Matmul, ShapeInference) {
     auto C = matmul->getOutputs()[0];
     EXPECT_EQ(C->getDims(), (Shape{2, 3, 2, 4}));
   }
+  {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto A = g->addTensor(Shape{4, 1, 2, 5});
+    auto B = g->addTensor(Shape{3, 5, 6});
+    auto matmul = g->addOp<MatmulObj>(A, B, nullptr);
+    auto C = matmul->getOutputs()[0];
+    EXPECT_EQ(C->getDims(), (Shape{4, 3, 2, 6}));
+    EXPECT_EQ(matmul->getM(), 2);
+    EXPECT_EQ(matmul->getN(), 6);
+    EXPECT_EQ(matmul->getK(), 5);
+  }
+  {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto A = g->addTensor(Shape{7, 5});
+    auto B = g->addTensor(Shape{2, 3, 6, 5});
+    auto matmul = g->addOp<MatmulObj>(A, B, nullptr, false, true);
+    auto C = matmul->getOutputs()[0];
+    EXPECT_EQ(C->getDims(), (Shape{2, 3, 7, 6}));
+  }
 }
 
 };  // namespace infini
\ No newline at end of file